@@ -54,6 +54,19 @@
 #define ES_OS_WIN32
 #endif // _WIN32, CYGWIN
 
+// SIMD
+#if defined(__SSE2__)
+#define ES_SIMD_SSE2
+#endif // __SSE2__
+#if defined(__ARM_NEON)
+#define ES_SIMD_NEON
+#endif // __ARM_NEON
+// AVX2 isn't part of the x86-64 baseline, so it's picked at runtime by
+// compilers able to target single functions. Define ES_NO_AVX2 to opt out.
+#if defined(ES_SIMD_SSE2) && defined(__GNUC__) && !defined(ES_NO_AVX2)
+#define ES_SIMD_AVX2_DISPATCH
+#endif // ES_SIMD_SSE2, __GNUC__, ES_NO_AVX2
+
 /*=========================*/
 // Includes
 /*=========================*/
@@ -78,6 +91,16 @@
 #include <vulkan/vulkan.h>
 #endif // ES_VULKAN
 
+#ifdef ES_SIMD_SSE2
+#include <emmintrin.h>
+#endif // ES_SIMD_SSE2
+#ifdef ES_SIMD_AVX2_DISPATCH
+#include <immintrin.h>
+#endif // ES_SIMD_AVX2_DISPATCH
+#ifdef ES_SIMD_NEON
+#include <arm_neon.h>
+#endif // ES_SIMD_NEON
+
 //
 // OS Specific
 //
@@ -145,6 +168,63 @@ typedef u32_t b32_t;
 #define NULL ((void *) 0)
 #endif // NULL
 
+/*=========================*/
+// Memory debugging
+/*=========================*/
+
+// Max amount of distinct allocation sites tracked.
+#ifndef ES_MEMORY_DEBUG_SITES
+#define ES_MEMORY_DEBUG_SITES 1024
+#endif // ES_MEMORY_DEBUG_SITES
+
+// Amount of power of two size classes in the per site histogram.
+#define ES_MEMORY_DEBUG_BUCKETS 12
+
+// Allocation statistics.
+typedef struct es_memory_stats_t {
+    // Bytes currently allocated.
+    usize_t live_bytes;
+    // Highest amount of bytes allocated at once.
+    usize_t peak_bytes;
+    // Allocations currently alive.
+    usize_t live_count;
+    // Allocations made in total, reallocations included.
+    usize_t total_count;
+} es_memory_stats_t;
+
+// Statistics for a single allocation site.
+typedef struct _es_memory_site_t {
+    const char *file;
+    const char *func;
+    u32_t line;
+    usize_t live_bytes;
+    usize_t live_count;
+    usize_t total_bytes;
+    usize_t total_count;
+    // Allocation count per size class, 16 bytes and up.
+    usize_t histogram[ES_MEMORY_DEBUG_BUCKETS];
+} _es_memory_site_t;
+
+// Tracked allocation functions, used by es_malloc and friends when ES_MEMORY_DEBUG is defined.
+ES_API void *_es_memory_malloc(usize_t size, const char *file, u32_t line, const char *func);
+ES_API void *_es_memory_calloc(usize_t count, usize_t size, const char *file, u32_t line, const char *func);
+ES_API void *_es_memory_realloc(void *ptr, usize_t size, const char *file, u32_t line, const char *func);
+ES_API void _es_memory_free(void *ptr);
+
+// Get global allocation statistics.
+ES_API es_memory_stats_t es_memory_stats(void);
+// Print global statistics and every allocation site, largest live usage first.
+ES_API void es_memory_report(void);
+
+// Route every library allocation through the tracker.
+// Has to be defined for every source file including the library.
+#ifdef ES_MEMORY_DEBUG
+#define es_malloc(SIZE) _es_memory_malloc((SIZE), __FILE__, __LINE__, __func__)
+#define es_calloc(COUNT, SIZE) _es_memory_calloc((COUNT), (SIZE), __FILE__, __LINE__, __func__)
+#define es_realloc(PTR, SIZE) _es_memory_realloc((PTR), (SIZE), __FILE__, __LINE__, __func__)
+#define es_free(PTR) _es_memory_free(PTR)
+#endif // ES_MEMORY_DEBUG
+
 /*=========================*/
 // User defines
 /*=========================*/
@@ -169,6 +249,97 @@ typedef u32_t b32_t;
 #include <malloc.h>
 #endif // es_free
 
+/*=========================*/
+// Allocator
+/*=========================*/
+
+// Runtime allocator interface containers can be bound to.
+typedef struct es_allocator_t {
+    void *(*alloc)(usize_t size, void *user);
+    void *(*realloc)(void *ptr, usize_t old_size, usize_t new_size, void *user);
+    void (*free)(void *ptr, usize_t size, void *user);
+    // Passed to every callback.
+    void *user;
+} es_allocator_t;
+
+// Allocate from allocator if one is provided, otherwise from the heap.
+#define _es_alloc(A, SIZE) ((A) != NULL ? (A)->alloc((SIZE), (A)->user) : es_malloc(SIZE))
+// Reallocate from allocator if one is provided, otherwise from the heap.
+#define _es_realloc(A, PTR, OLD, NEW) ((A) != NULL ? (A)->realloc((PTR), (OLD), (NEW), (A)->user) : es_realloc((PTR), (NEW)))
+// Free to allocator if one is provided, otherwise to the heap.
+#define _es_free(A, PTR, SIZE) do { \
+    if ((A) != NULL) { \
+        (A)->free((PTR), (SIZE), (A)->user); \
+    } else { \
+        es_free(PTR); \
+    } \
+} while (0)
+
+/*=========================*/
+// Arena
+/*=========================*/
+
+// Default minimum size of an arena chunk.
+#ifndef ES_ARENA_CHUNK_SIZE
+#define ES_ARENA_CHUNK_SIZE (64 * 1024)
+#endif // ES_ARENA_CHUNK_SIZE
+
+// Alignment of every arena allocation.
+#define ES_ARENA_ALIGNMENT 16
+
+// Header struct placed before every block of arena memory.
+typedef struct _es_arena_chunk_t {
+    // Previously filled chunk.
+    struct _es_arena_chunk_t *prev;
+    // Usable bytes in chunk.
+    usize_t cap;
+    // Used bytes in chunk.
+    usize_t used;
+} _es_arena_chunk_t;
+
+// Bump allocator handing out memory from a chain of chunks.
+typedef struct es_arena_t {
+    // Chunk allocations are currently made from.
+    _es_arena_chunk_t *chunk;
+    // Minimum size of new chunks.
+    usize_t chunk_size;
+    // Allocator interface handed out by es_arena_allocator.
+    es_allocator_t allocator;
+} es_arena_t;
+
+// Position in an arena which can be rewound to.
+typedef struct es_arena_mark_t {
+    _es_arena_chunk_t *chunk;
+    usize_t used;
+} es_arena_mark_t;
+
+// Align a size to the arena alignment.
+#define _es_arena_align(S) (((S) + (ES_ARENA_ALIGNMENT - 1)) & ~((usize_t) ES_ARENA_ALIGNMENT - 1))
+// Get the start of chunk memory from a chunk header.
+#define _es_arena_chunk_ptr(C) ((u8_t *) (C) + _es_arena_align(sizeof(_es_arena_chunk_t)))
+
+// Create an arena. A chunk size of 0 uses ES_ARENA_CHUNK_SIZE.
+ES_API es_arena_t es_arena_init(usize_t chunk_size);
+// Free every chunk owned by arena.
+ES_API void es_arena_free(es_arena_t *arena);
+// Allocate memory from arena.
+ES_API void *es_arena_alloc(es_arena_t *arena, usize_t size);
+// Resize an allocation. Grows in place if it's the latest allocation.
+ES_API void *es_arena_realloc(es_arena_t *arena, void *ptr, usize_t old_size, usize_t new_size);
+// Get current arena position.
+ES_API es_arena_mark_t es_arena_mark(const es_arena_t *arena);
+// Free everything allocated after mark was taken.
+ES_API void es_arena_rewind(es_arena_t *arena, es_arena_mark_t mark);
+// Free all allocations but keep the memory around for reuse.
+ES_API void es_arena_reset(es_arena_t *arena);
+// Get an allocator interface for arena. Valid for as long as arena is.
+ES_API const es_allocator_t *es_arena_allocator(es_arena_t *arena);
+
+// Arena allocator callbacks.
+ES_API void *_es_arena_allocator_alloc(usize_t size, void *user);
+ES_API void *_es_arena_allocator_realloc(void *ptr, usize_t old_size, usize_t new_size, void *user);
+ES_API void _es_arena_allocator_free(void *ptr, usize_t size, void *user);
+
 /*=========================*/
 // Dynamic array
 /*=========================*/
@@ -181,18 +352,30 @@ typedef struct _es_da_header_t {
     usize_t cap;
     // Size of entry.
     usize_t size;
+    // Allocator memory is allocated from. NULL means heap.
+    const es_allocator_t *allocator;
 } _es_da_header_t;
 
 // Initial size of dynamic array.
 #define _ES_DA_INIT_CAP 8
 
+// Capacity multiplier used when a dynamic array grows.
+#ifndef ES_DA_GROWTH_FACTOR
+#define ES_DA_GROWTH_FACTOR 2.0f
+#endif // ES_DA_GROWTH_FACTOR
+
+// Dynamic array halves its capacity once only 1/ES_DA_SHRINK_THRESHOLD of it is used.
+#ifndef ES_DA_SHRINK_THRESHOLD
+#define ES_DA_SHRINK_THRESHOLD 4
+#endif // ES_DA_SHRINK_THRESHOLD
+
 // Get the head of dynamic array from a pointer.
 #define _es_da_head(P) ((_es_da_header_t *) ((u8_t *) (P) - sizeof(_es_da_header_t)))
 // Get the start of dynamic array from a head.
 #define _es_da_ptr(H) ((void *) ((u8_t *) (H) + sizeof(_es_da_header_t)))
 
-// Initialize a new dynamic array.
-ES_API void _es_da_init(void **arr, usize_t size);
+// Initialize a new dynamic array. A NULL allocator allocates from the heap.
+ES_API void _es_da_init(void **arr, usize_t size, const es_allocator_t *allocator);
 // Free dynamic array.
 ES_API void _es_da_free_impl(void **arr);
 
@@ -211,21 +394,43 @@ ES_API void _es_da_insert_arr_impl(void **arr, const void *data, usize_t count,
 // Remove whole array from dynamic array.
 ES_API void _es_da_remove_arr_impl(void **arr, usize_t count, usize_t index, void *output);
 
+// Append count copies of data with a single capacity check.
+ES_API void _es_da_append_n_impl(void **arr, const void *data, usize_t count);
+// Append every entry of another dynamic array.
+ES_API void _es_da_extend_impl(void **arr, const void *other);
+// Replace remove_count entries at index with insert_count entries from data.
+ES_API void _es_da_splice_impl(void **arr, usize_t index, usize_t remove_count, const void *data, usize_t insert_count);
+// Set entry count, growing if needed, without initializing new entries.
+ES_API void _es_da_resize_uninit_impl(void **arr, usize_t count);
+
+// Make room for one more entry, initializing the array if needed.
+ES_API void _es_da_grow(void **arr, usize_t size);
 // Resize dynamic array, if needed, according to insertion/removal count.
 ES_API void _es_da_resize(void **arr, isize_t count);
+// Reallocate dynamic array to an exact capacity.
+ES_API void _es_da_set_cap(void **arr, usize_t cap);
+// Grow dynamic array to fit at least cap entries.
+ES_API void _es_da_reserve_impl(void **arr, usize_t cap);
 
 // Get the amount of entries in  dynamic array.
 ES_API usize_t es_da_count(const void *arr);
+// Get the amount of entries dynamic array can hold before growing.
+ES_API usize_t es_da_cap(const void *arr);
 
 // Declare dyanmic array.
 #define es_da(T) T *
 
+// Initialize dynamic array with memory from an allocator.
+#define es_da_init_allocator(ARR, A) _es_da_init((void **) &(ARR), sizeof(*(ARR)), (A))
+// Initialize dynamic array with memory from an arena.
+#define es_da_init_arena(ARR, ARENA) es_da_init_allocator(ARR, es_arena_allocator(ARENA))
+
 // Free a dynamic array.
 #define es_da_free(ARR) _es_da_free_impl((void **) &(ARR))
 
 // Insert an entry into dynamic array.
 #define es_da_insert(ARR, D, I) do { \
-    _es_da_init((void **) &(ARR), sizeof(*(ARR))); \
+    _es_da_init((void **) &(ARR), sizeof(*(ARR)), NULL); \
     __typeof__(D) _es_da_temp_data = D; \
     _es_da_insert_impl((void **) &(ARR), &_es_da_temp_data, (I)); \
 } while(0)
@@ -234,21 +439,40 @@ ES_API usize_t es_da_count(const void *arr);
 
 // Insert an entry into dynamic array disregarding the order.
 #define es_da_insert_fast(ARR, D, I) do { \
-    _es_da_init((void **) &(ARR), sizeof(*(ARR))); \
+    _es_da_init((void **) &(ARR), sizeof(*(ARR)), NULL); \
     __typeof__(D) _es_da_temp_data = D; \
     _es_da_insert_fast_impl((void **) &(ARR), &_es_da_temp_data, (I)); \
 } while(0)
 // Remove an entry from dynamic array disregarding the order.
 #define es_da_remove_fast(ARR, I, OUT) _es_da_remove_fast_impl((void **) &(ARR), (I), (OUT))
 
-// Insert entry at the end of dynamic array.
-#define es_da_push(ARR, D) es_da_insert_fast(ARR, D, es_da_count((ARR)))
-// Remove entry at the end of dynamic array.
-#define es_da_pop(ARR, OUT) es_da_remove_fast(ARR, es_da_count((ARR)) - 1, OUT)
+// Insert entry at the end of dynamic array. Only calls out of line when full.
+#define es_da_push(ARR, D) do { \
+    __typeof__(*(ARR)) _es_da_temp_data = (D); \
+    if ((ARR) == NULL || _es_da_head(ARR)->count == _es_da_head(ARR)->cap) { \
+        _es_da_grow((void **) &(ARR), sizeof(*(ARR))); \
+    } \
+    (ARR)[_es_da_head(ARR)->count] = _es_da_temp_data; \
+    _es_da_head(ARR)->count++; \
+} while (0)
+// Remove entry at the end of dynamic array. Only calls out of line when shrinking.
+#define es_da_pop(ARR, OUT) do { \
+    es_assert((ARR) != NULL && _es_da_head(ARR)->count > 0, "Can't pop from an empty array.", NULL); \
+    _es_da_header_t *_es_da_temp_head = _es_da_head(ARR); \
+    void *_es_da_temp_out = (OUT); \
+    if (_es_da_temp_head->count - 1 <= _es_da_temp_head->cap / ES_DA_SHRINK_THRESHOLD && _es_da_temp_head->cap > _ES_DA_INIT_CAP) { \
+        es_da_remove_fast(ARR, _es_da_temp_head->count - 1, _es_da_temp_out); \
+        break; \
+    } \
+    _es_da_temp_head->count--; \
+    if (_es_da_temp_out != NULL) { \
+        memcpy(_es_da_temp_out, &(ARR)[_es_da_temp_head->count], sizeof(*(ARR))); \
+    } \
+} while (0)
 
 // Insert a whole array into dynamic array.
 #define es_da_insert_arr(ARR, D, C, I) do { \
-    _es_da_init((void **) &(ARR), sizeof(*(ARR))); \
+    _es_da_init((void **) &(ARR), sizeof(*(ARR)), NULL); \
     _es_da_insert_arr_impl((void **) &(ARR), (D), (C), (I)); \
 } while (0)
 // Remove a whole array from dynamic array.
@@ -259,12 +483,366 @@ ES_API usize_t es_da_count(const void *arr);
 // Remove array from the end of dynamic array.
 #define es_da_pop_arr(ARR, C, OUT) es_da_remove_arr(ARR, C, es_da_count((ARR)) - (C), OUT)
 
+// Make room for at least N entries without further reallocation.
+#define es_da_reserve(ARR, N) do { \
+    _es_da_init((void **) &(ARR), sizeof(*(ARR)), NULL); \
+    _es_da_reserve_impl((void **) &(ARR), (N)); \
+} while (0)
+// Shrink capacity to the entry count.
+#define es_da_shrink_to_fit(ARR) do { \
+    if ((ARR) != NULL) { \
+        _es_da_set_cap((void **) &(ARR), es_da_count(ARR)); \
+    } \
+} while (0)
+
+// Append N copies of an entry.
+#define es_da_append_n(ARR, D, N) do { \
+    _es_da_init((void **) &(ARR), sizeof(*(ARR)), NULL); \
+    __typeof__(*(ARR)) _es_da_temp_data = (D); \
+    _es_da_append_n_impl((void **) &(ARR), &_es_da_temp_data, (N)); \
+} while (0)
+// Append every entry of another dynamic array of the same type.
+#define es_da_extend_from(ARR, OTHER) do { \
+    _es_da_init((void **) &(ARR), sizeof(*(ARR)), NULL); \
+    _es_da_extend_impl((void **) &(ARR), (OTHER)); \
+} while (0)
+// Replace R entries at index I with C entries from D. NULL data inserts zeroed entries.
+#define es_da_splice(ARR, I, R, D, C) do { \
+    _es_da_init((void **) &(ARR), sizeof(*(ARR)), NULL); \
+    _es_da_splice_impl((void **) &(ARR), (I), (R), (D), (C)); \
+} while (0)
+// Set entry count to N. New entries are left uninitialized.
+#define es_da_resize_uninit(ARR, N) do { \
+    _es_da_init((void **) &(ARR), sizeof(*(ARR)), NULL); \
+    _es_da_resize_uninit_impl((void **) &(ARR), (N)); \
+} while (0)
+// Remove every entry but keep the capacity.
+#define es_da_clear(ARR) do { \
+    if ((ARR) != NULL) { \
+        _es_da_head(ARR)->count = 0; \
+    } \
+} while (0)
+
+// Marks a dynamic array header living in es_sda inline storage.
+ES_GLOBAL const es_allocator_t _es_sda_allocator_g;
+
+// Declare a dynamic array with inline storage for N entries before spilling to the heap.
+#define es_sda(T, N) struct { \
+    _es_da_header_t head; \
+    T inline_data[N]; \
+}
+// Initialize small dynamic array storage and get a dynamic array using it.
+// The result works with every es_da function and es_da_free only frees spilled memory.
+#define es_sda_init(SDA) ((__typeof__(&(SDA).inline_data[0])) _es_sda_init_impl( \
+    &(SDA).head, \
+    sizeof((SDA).inline_data[0]), \
+    es_arr_len((SDA).inline_data), \
+    es_offset(__typeof__(SDA), inline_data) \
+))
+// Check if dynamic array still uses inline storage.
+#define es_sda_is_inline(ARR) ((ARR) != NULL && _es_da_head(ARR)->allocator == &_es_sda_allocator_g)
+
+// Amount of entries before sorting is split across threads.
+#ifndef ES_DA_SORT_PARALLEL_THRESHOLD
+#define ES_DA_SORT_PARALLEL_THRESHOLD 65536
+#endif // ES_DA_SORT_PARALLEL_THRESHOLD
+
+// Amount of threads used for a parallel sort.
+#ifndef ES_DA_SORT_THREADS
+#define ES_DA_SORT_THREADS 4
+#endif // ES_DA_SORT_THREADS
+
+// Compare two entries. Negative when a goes before b, zero when equal and positive otherwise.
+typedef i32_t (*es_cmp_func_t)(const void *a, const void *b);
+
+// Sort dynamic array with introsort, or a stable merge sort.
+ES_API void _es_da_sort_impl(void *arr, es_cmp_func_t cmp, b8_t stable);
+// Get index of the first entry not ordered before key.
+ES_API usize_t _es_da_lower_bound_impl(const void *arr, const void *key, es_cmp_func_t cmp);
+// Find an entry equal to key in a sorted dynamic array.
+ES_API void *_es_da_bsearch_impl(const void *arr, const void *key, es_cmp_func_t cmp);
+
+// Sort dynamic array. Large arrays are sorted in parallel.
+#define es_da_sort(ARR, CMP) _es_da_sort_impl((ARR), (CMP), false)
+// Sort dynamic array keeping the order of equal entries.
+#define es_da_sort_stable(ARR, CMP) _es_da_sort_impl((ARR), (CMP), true)
+// Get index of the first entry not ordered before the entry KEY points to.
+// The comparator receives the array entry first and KEY second.
+#define es_da_lower_bound(ARR, KEY, CMP) _es_da_lower_bound_impl((ARR), (KEY), (CMP))
+// Get pointer to an entry equal to the entry KEY points to, or NULL if missing.
+#define es_da_bsearch(ARR, KEY, CMP) ((__typeof__(ARR)) _es_da_bsearch_impl((ARR), (KEY), (CMP)))
+
+// Initialize the header of inline storage.
+ES_API void *_es_sda_init_impl(_es_da_header_t *head, usize_t size, usize_t cap, usize_t data_offset);
+
 // Retrieve last item in array.
 #define es_da_last(ARR) (ARR)[es_da_count(ARR) - 1]
 
 // Iterate over a dynamic array.
 #define es_da_iter(DA, I) for (usize_t I = 0; I < es_da_count(DA); i++)
 
+/*=========================*/
+// Chunked dynamic array
+/*=========================*/
+
+// Size in bytes of a chunked dynamic array block.
+#ifndef ES_CHUNKED_DA_BLOCK_SIZE
+#define ES_CHUNKED_DA_BLOCK_SIZE 4096
+#endif // ES_CHUNKED_DA_BLOCK_SIZE
+
+// Entries live in fixed size blocks that are never moved, so pointers to
+// entries stay valid until the entry is removed.
+typedef struct es_chunked_da_t {
+    es_da(u8_t *) blocks;
+    usize_t count;
+    usize_t size;
+    usize_t block_shift;
+    const es_allocator_t *allocator;
+} es_chunked_da_t;
+
+// Set entry size and allocator of an empty chunked dynamic array.
+ES_API void _es_chunked_da_init(es_chunked_da_t *cda, usize_t size, const es_allocator_t *allocator);
+// Free every block and the index table.
+ES_API void _es_chunked_da_free_impl(es_chunked_da_t *cda);
+// Make room for one more entry at the end and get a pointer to it.
+ES_API void *_es_chunked_da_push_impl(es_chunked_da_t *cda, usize_t size);
+// Remove the last entry.
+ES_API void _es_chunked_da_pop_impl(es_chunked_da_t *cda, void *out);
+// Free blocks past the last entry.
+ES_API void _es_chunked_da_shrink_to_fit_impl(es_chunked_da_t *cda);
+// Get the amount of blocks holding entries.
+ES_API usize_t _es_chunked_da_block_count_impl(const es_chunked_da_t *cda);
+// Get the amount of entries in a block.
+ES_API usize_t _es_chunked_da_block_len_impl(const es_chunked_da_t *cda, usize_t block);
+
+// Declare chunked dynamic array. A zeroed one is empty and ready to use.
+#define es_chunked_da(T) union { \
+    es_chunked_da_t da; \
+    T *_type; \
+}
+
+// Initialize chunked dynamic array with memory from an allocator.
+#define es_chunked_da_init_allocator(CDA, A) _es_chunked_da_init(&(CDA).da, sizeof(*(CDA)._type), (A))
+// Initialize chunked dynamic array with memory from an arena.
+#define es_chunked_da_init_arena(CDA, ARENA) es_chunked_da_init_allocator(CDA, es_arena_allocator(ARENA))
+// Free a chunked dynamic array.
+#define es_chunked_da_free(CDA) _es_chunked_da_free_impl(&(CDA).da)
+
+// Get the amount of entries in chunked dynamic array.
+#define es_chunked_da_count(CDA) ((CDA).da.count)
+// Access entry at index I. The index isn't bounds checked.
+#define es_chunked_da_at(CDA, I) \
+    (((__typeof__((CDA)._type)) (CDA).da.blocks[(I) >> (CDA).da.block_shift]) \
+     [(I) & (((usize_t) 1 << (CDA).da.block_shift) - 1)])
+// Access the last entry.
+#define es_chunked_da_last(CDA) es_chunked_da_at(CDA, (CDA).da.count - 1)
+
+// Insert entry at the end. Existing entries are never copied.
+#define es_chunked_da_push(CDA, D) do { \
+    __typeof__(*(CDA)._type) _es_cda_temp_data = (D); \
+    *(__typeof__((CDA)._type)) _es_chunked_da_push_impl(&(CDA).da, sizeof(_es_cda_temp_data)) = _es_cda_temp_data; \
+} while (0)
+// Remove the last entry. Blocks are kept for reuse.
+#define es_chunked_da_pop(CDA, OUT) _es_chunked_da_pop_impl(&(CDA).da, (OUT))
+// Remove every entry but keep the blocks.
+#define es_chunked_da_clear(CDA) ((void) ((CDA).da.count = 0))
+// Free blocks not holding any entries.
+#define es_chunked_da_shrink_to_fit(CDA) _es_chunked_da_shrink_to_fit_impl(&(CDA).da)
+
+// Get the amount of blocks holding entries, for block by block iteration.
+#define es_chunked_da_block_count(CDA) _es_chunked_da_block_count_impl(&(CDA).da)
+// Get pointer to the first entry of block B.
+#define es_chunked_da_block(CDA, B) ((__typeof__((CDA)._type)) (CDA).da.blocks[B])
+// Get the amount of entries in block B.
+#define es_chunked_da_block_len(CDA, B) _es_chunked_da_block_len_impl(&(CDA).da, (B))
+
+/*=========================*/
+// Ring buffer
+/*=========================*/
+
+// Starting capacity of a ring buffer. Must be a power of two.
+#define _ES_RING_INIT_CAP 8
+
+// Double ended queue over a power of two sized circular buffer.
+typedef struct es_ring_t {
+    u8_t *data;
+    usize_t head;
+    usize_t count;
+    usize_t cap;
+    usize_t size;
+    const es_allocator_t *allocator;
+} es_ring_t;
+
+// Set entry size and allocator of an empty ring buffer.
+ES_API void _es_ring_init(es_ring_t *ring, usize_t size, const es_allocator_t *allocator);
+// Free ring buffer memory.
+ES_API void _es_ring_free_impl(es_ring_t *ring);
+// Grow capacity to the smallest power of two fitting cap entries, unwrapping entries as needed.
+ES_API void _es_ring_reserve_impl(es_ring_t *ring, usize_t size, usize_t cap);
+// Copy count entries to the back.
+ES_API void _es_ring_push_back_arr_impl(es_ring_t *ring, const void *data, usize_t count);
+// Remove count entries from the front, copying them to out if not NULL.
+ES_API void _es_ring_pop_front_arr_impl(es_ring_t *ring, usize_t count, void *out);
+// Get pointer to entry at index and the amount of entries stored contiguously from it.
+ES_API void *_es_ring_span_impl(const es_ring_t *ring, usize_t index, usize_t *len);
+
+// Declare ring buffer. A zeroed one is empty and ready to use.
+#define es_ring(T) union { \
+    es_ring_t ring; \
+    T *_type; \
+}
+// Declare double ended queue. Same as a ring buffer.
+#define es_deque(T) es_ring(T)
+
+// Initialize ring buffer with memory from an allocator.
+#define es_ring_init_allocator(R, A) _es_ring_init(&(R).ring, sizeof(*(R)._type), (A))
+// Initialize ring buffer with memory from an arena.
+#define es_ring_init_arena(R, ARENA) es_ring_init_allocator(R, es_arena_allocator(ARENA))
+// Free a ring buffer.
+#define es_ring_free(R) _es_ring_free_impl(&(R).ring)
+
+// Get the amount of entries in ring buffer.
+#define es_ring_count(R) ((R).ring.count)
+// Get the amount of entries ring buffer can hold before growing.
+#define es_ring_cap(R) ((R).ring.cap)
+// Make room for at least N entries without further reallocation.
+#define es_ring_reserve(R, N) _es_ring_reserve_impl(&(R).ring, sizeof(*(R)._type), (N))
+// Remove every entry but keep the capacity.
+#define es_ring_clear(R) ((void) ((R).ring.head = 0, (R).ring.count = 0))
+
+// Access entry at index I counted from the front. The index isn't bounds checked.
+#define es_ring_at(R, I) (((__typeof__((R)._type)) (R).ring.data)[((R).ring.head + (I)) & ((R).ring.cap - 1)])
+// Access the first entry.
+#define es_ring_front(R) es_ring_at(R, 0)
+// Access the last entry.
+#define es_ring_back(R) es_ring_at(R, (R).ring.count - 1)
+
+// Insert entry at the back.
+#define es_ring_push_back(R, D) do { \
+    __typeof__(*(R)._type) _es_ring_temp_data = (D); \
+    if ((R).ring.count == (R).ring.cap) { \
+        _es_ring_reserve_impl(&(R).ring, sizeof(*(R)._type), (R).ring.count + 1); \
+    } \
+    (R).ring.count++; \
+    es_ring_back(R) = _es_ring_temp_data; \
+} while (0)
+// Insert entry at the front.
+#define es_ring_push_front(R, D) do { \
+    __typeof__(*(R)._type) _es_ring_temp_data = (D); \
+    if ((R).ring.count == (R).ring.cap) { \
+        _es_ring_reserve_impl(&(R).ring, sizeof(*(R)._type), (R).ring.count + 1); \
+    } \
+    (R).ring.head = ((R).ring.head - 1) & ((R).ring.cap - 1); \
+    (R).ring.count++; \
+    es_ring_front(R) = _es_ring_temp_data; \
+} while (0)
+// Remove entry from the back, copying it to OUT if not NULL.
+#define es_ring_pop_back(R, OUT) do { \
+    void *_es_ring_temp_out = (OUT); \
+    es_assert((R).ring.count > 0, "Can't pop from an empty ring buffer.", NULL); \
+    if (_es_ring_temp_out != NULL) { \
+        memcpy(_es_ring_temp_out, &es_ring_back(R), sizeof(*(R)._type)); \
+    } \
+    (R).ring.count--; \
+} while (0)
+// Remove entry from the front, copying it to OUT if not NULL.
+#define es_ring_pop_front(R, OUT) do { \
+    void *_es_ring_temp_out = (OUT); \
+    es_assert((R).ring.count > 0, "Can't pop from an empty ring buffer.", NULL); \
+    if (_es_ring_temp_out != NULL) { \
+        memcpy(_es_ring_temp_out, &es_ring_front(R), sizeof(*(R)._type)); \
+    } \
+    (R).ring.head = ((R).ring.head + 1) & ((R).ring.cap - 1); \
+    (R).ring.count--; \
+} while (0)
+
+// Insert C entries from array D at the back.
+#define es_ring_push_back_arr(R, D, C) do { \
+    _es_ring_reserve_impl(&(R).ring, sizeof(*(R)._type), (R).ring.count + (C)); \
+    _es_ring_push_back_arr_impl(&(R).ring, (D), (C)); \
+} while (0)
+// Remove C entries from the front, copying them to OUT if not NULL.
+#define es_ring_pop_front_arr(R, C, OUT) _es_ring_pop_front_arr_impl(&(R).ring, (C), (OUT))
+
+// Get pointer to entry I and store the amount of entries following it contiguously in LEN.
+// Consuming the span at index 0 then the one after it visits every entry without copying.
+#define es_ring_span(R, I, LEN) ((__typeof__((R)._type)) _es_ring_span_impl(&(R).ring, (I), (LEN)))
+// Drop N entries from the front after consuming them through a span.
+#define es_ring_consume(R, N) es_ring_pop_front_arr(R, N, NULL)
+
+/*=========================*/
+// Structure of arrays
+/*=========================*/
+
+// Maximum amount of fields in a structure of arrays.
+#ifndef ES_SOA_MAX_COLUMNS
+#define ES_SOA_MAX_COLUMNS 16
+#endif // ES_SOA_MAX_COLUMNS
+
+// Shared count and capacity of every column. The typed column pointers follow it
+// directly and are copies of columns, refreshed whenever the columns move.
+typedef struct es_soa_t {
+    usize_t count;
+    usize_t cap;
+    usize_t column_count;
+    usize_t sizes[ES_SOA_MAX_COLUMNS];
+    void *columns[ES_SOA_MAX_COLUMNS];
+    const es_allocator_t *allocator;
+} es_soa_t;
+
+// Set column entry sizes and allocator.
+ES_API void _es_soa_init(es_soa_t *soa, const usize_t *sizes, usize_t column_count, usize_t total_size, const es_allocator_t *allocator);
+// Free every column and clear the typed column pointers in fields.
+ES_API void _es_soa_free_impl(es_soa_t *soa, void *fields);
+// Grow every column to fit at least cap entries and copy the new pointers to fields.
+ES_API void _es_soa_reserve_impl(es_soa_t *soa, void *fields, usize_t cap);
+// Append a zeroed row and get its index.
+ES_API usize_t _es_soa_push_impl(es_soa_t *soa, void *fields);
+// Remove a row keeping the order.
+ES_API void _es_soa_remove_impl(es_soa_t *soa, usize_t index);
+// Remove a row by moving the last row into its place.
+ES_API void _es_soa_remove_fast_impl(es_soa_t *soa, usize_t index);
+// Swap two rows.
+ES_API void _es_soa_swap_impl(es_soa_t *soa, usize_t a, usize_t b);
+
+#define _es_soa_column(T, NAME) T *NAME;
+#define _es_soa_size(T, NAME) sizeof(T),
+#define _es_soa_fields(SOA) ((void *) (&(SOA).soa + 1))
+
+// Declare structure of arrays from an X macro listing the fields:
+//     #define PARTICLE_FIELDS(X) X(vec3_t, pos) X(vec3_t, vel) X(f32_t, life)
+//     es_soa(PARTICLE_FIELDS) particles;
+// Every field becomes a contiguous array, particles.pos[i], sharing one count.
+#define es_soa(FIELDS) struct { \
+    es_soa_t soa; \
+    FIELDS(_es_soa_column) \
+}
+
+// Initialize structure of arrays with memory from an allocator.
+#define es_soa_init_allocator(SOA, FIELDS, A) do { \
+    const usize_t _es_soa_temp_sizes[] = { FIELDS(_es_soa_size) }; \
+    _es_soa_init(&(SOA).soa, _es_soa_temp_sizes, es_arr_len(_es_soa_temp_sizes), sizeof(SOA), (A)); \
+} while (0)
+// Initialize structure of arrays on the heap.
+#define es_soa_init(SOA, FIELDS) es_soa_init_allocator(SOA, FIELDS, NULL)
+// Free a structure of arrays.
+#define es_soa_free(SOA) _es_soa_free_impl(&(SOA).soa, _es_soa_fields(SOA))
+
+// Get the amount of rows.
+#define es_soa_count(SOA) ((SOA).soa.count)
+// Make room for at least N rows without further reallocation.
+#define es_soa_reserve(SOA, N) _es_soa_reserve_impl(&(SOA).soa, _es_soa_fields(SOA), (N))
+// Append a zeroed row to every column and get its index.
+#define es_soa_push(SOA) _es_soa_push_impl(&(SOA).soa, _es_soa_fields(SOA))
+// Remove row I from every column keeping the order.
+#define es_soa_remove(SOA, I) _es_soa_remove_impl(&(SOA).soa, (I))
+// Remove row I from every column disregarding the order.
+#define es_soa_remove_fast(SOA, I) _es_soa_remove_fast_impl(&(SOA).soa, (I))
+// Swap rows A and B in every column.
+#define es_soa_swap(SOA, A, B) _es_soa_swap_impl(&(SOA).soa, (A), (B))
+// Remove every row but keep the capacity.
+#define es_soa_clear(SOA) ((void) ((SOA).soa.count = 0))
+
 /*=========================*/
 // Assert
 /*=========================*/
@@ -315,10 +893,33 @@ ES_API void _es_assert_impl(const char *file, u32_t line, const char *expr_str,
 #define ES_U32_MAX 4294967295
 #define ES_U64_MAX 18446744073709551615
 
+// Hash function usable by hash tables.
+typedef usize_t (*es_hash_func_t)(const void *data, usize_t len, usize_t seed);
+
+// Streaming wyhash state. Hashing data in pieces gives the same result as es_wyhash.
+typedef struct es_hasher_t {
+    u64_t seed;
+    u64_t see1;
+    u64_t see2;
+    u64_t len;
+    u8_t buffer[48];
+    u8_t last[16];
+    usize_t buffered;
+} es_hasher_t;
+
 // Hash string.
 ES_API usize_t es_hash_str(const char *str);
 // Hash any data (except string).
 ES_API usize_t es_siphash(const void *data, usize_t len, usize_t seed);
+// Hash any data with wyhash. Much faster than es_siphash but not keyed against hash flooding.
+ES_API usize_t es_wyhash(const void *data, usize_t len, usize_t seed);
+
+// Start hashing data in pieces.
+ES_API es_hasher_t es_hasher_init(usize_t seed);
+// Hash another piece of data.
+ES_API void es_hasher_update(es_hasher_t *hasher, const void *data, usize_t len);
+// Get hash of every piece so far.
+ES_API usize_t es_hasher_final(const es_hasher_t *hasher);
 
 // Get current time in milliseconds.
 ES_API f64_t es_get_time(void);
@@ -331,129 +932,219 @@ ES_API void _es_win32_clock_setup(void);
 // Hash table
 /*=========================*/
 
-#define ES_HASH_TABLE_MAX_CAP 0.75f
+// Default maximum ratio of alive entries and tombstones to slots before a hash table grows.
+// An overridden ES_HASH_TABLE_MAX_CAP is still honored.
+#ifndef ES_HASH_TABLE_MAX_LOAD
+#ifdef ES_HASH_TABLE_MAX_CAP
+#define ES_HASH_TABLE_MAX_LOAD ES_HASH_TABLE_MAX_CAP
+#else
+#define ES_HASH_TABLE_MAX_LOAD 0.875f
+#endif // ES_HASH_TABLE_MAX_CAP
+#endif // ES_HASH_TABLE_MAX_LOAD
+
+// Deprecated, use ES_HASH_TABLE_MAX_LOAD.
+#ifndef ES_HASH_TABLE_MAX_CAP
+#define ES_HASH_TABLE_MAX_CAP ES_HASH_TABLE_MAX_LOAD
+#endif // ES_HASH_TABLE_MAX_CAP
+
 #define ES_HASH_TABLE_SEED 0x2664424Cul
 
-// State of entry.
-typedef enum _es_hash_table_entry_state_t {
-    _ES_HASH_TABLE_ENTRY_DEAD  = 0,
-    _ES_HASH_TABLE_ENTRY_ALIVE = 1,
-} _es_hash_table_entry_state_t;
+// Amount of control bytes probed at once.
+#define _ES_HASH_TABLE_GROUP 16
+
+// Control byte of a slot. Alive slots store the low 7 bits of their hash.
+// Removed slots become tombstones so probe sequences running through them stay intact.
+#define _ES_HASH_TABLE_CTRL_EMPTY     0x80
+#define _ES_HASH_TABLE_CTRL_TOMBSTONE 0xfe
+
+// Old slots migrated per insert or remove while a hash table rehashes incrementally.
+#ifndef ES_HASH_TABLE_MIGRATE_SLOTS
+#define ES_HASH_TABLE_MIGRATE_SLOTS 64
+#endif // ES_HASH_TABLE_MIGRATE_SLOTS
+
+// Hash offset of entries which don't store their hash. Their keys are hashed again when rehashing.
+#define _ES_HASH_TABLE_NO_HASH ((usize_t) -1)
+
+// Where the engine finds the parts of an entry.
+typedef struct _es_hash_table_layout_t {
+    usize_t entry_size;
+    usize_t key_offset;
+    usize_t key_size;
+    usize_t value_offset;
+    usize_t value_size;
+    usize_t hash_offset;
+    b8_t string_key;
+} _es_hash_table_layout_t;
+
+// Untyped view of a hash table. Must match the start of es_hash_table.
+typedef struct _es_hash_table_head_t {
+    void *entries;
+    es_da(u8_t) ctrl;
+    usize_t count;
+    usize_t tombstones;
+    f32_t max_load;
+    b8_t string_key;
+    b8_t incremental;
+    const es_allocator_t *allocator;
+    void *old_entries;
+    es_da(u8_t) old_ctrl;
+    usize_t migrated;
+    es_hash_func_t hash_func;
+} _es_hash_table_head_t;
 
 // Create entry struct from key and value.
 #define _es_hash_table_entry(K, V) struct { \
     K key; \
     V value; \
-    _es_hash_table_entry_state_t state; \
     usize_t hash; \
 }
 
 // Create hash table struct from key and value.
+// Entries hold one extra zeroed entry past the capacity which is returned for missing keys.
+// While rehashing incrementally, entries not yet migrated live in the old arrays.
 #define es_hash_table(K, V) struct { \
     es_da(_es_hash_table_entry(K, V)) entries; \
-    _es_hash_table_entry(K, V) *temp_entry; \
-    K temp_key; \
-    b8_t string_key; \
+    es_da(u8_t) ctrl; \
     usize_t count; \
+    usize_t tombstones; \
+    f32_t max_load; \
+    b8_t string_key; \
+    b8_t incremental; \
+    const es_allocator_t *allocator; \
+    es_da(_es_hash_table_entry(K, V)) old_entries; \
+    es_da(u8_t) old_ctrl; \
+    usize_t migrated; \
+    es_hash_func_t hash_func; \
+    _es_hash_table_entry(K, V) *temp_entry; \
 } *
 
-// Initialize hash table.
-#define _es_hash_table_init(HT) do { \
+// Get the untyped view of a hash table.
+#define _es_hash_table_head(HT) ((_es_hash_table_head_t *) (HT))
+
+// Describe the entry layout of a hash table.
+#define _es_hash_table_layout(HT) _es_hash_table_layout_of((HT)->entries, (HT)->string_key)
+// Describe the layout of the entry type ENTRY_PTR points to.
+#define _es_hash_table_layout_of(ENTRY_PTR, STRING_KEY) (&(const _es_hash_table_layout_t) { \
+    sizeof(*(ENTRY_PTR)), \
+    es_offset(__typeof__(*(ENTRY_PTR)), key), \
+    sizeof((ENTRY_PTR)->key), \
+    es_offset(__typeof__(*(ENTRY_PTR)), value), \
+    sizeof((ENTRY_PTR)->value), \
+    es_offset(__typeof__(*(ENTRY_PTR)), hash), \
+    (STRING_KEY), \
+})
+
+// Get the amount of slots in a hash table. Always a power of two.
+#define _es_hash_table_cap(HT) es_da_count((HT)->ctrl)
+
+// Initialize anything sharing the hash table head with entries described by LAYOUT.
+#define _es_hash_table_init_layout(HT, A, LAYOUT) do { \
     if ((HT) != NULL) { \
         break; \
     } \
+    const es_allocator_t *ht_allocator = (A); \
     usize_t ht_size = sizeof(*(HT)); \
-    (HT) = es_malloc(ht_size); \
+    (HT) = _es_alloc(ht_allocator, ht_size); \
     memset((HT), 0, ht_size); \
-    (HT)->entries = NULL; \
-    es_da_push_arr((HT)->entries, NULL, 8); \
-    (HT)->string_key = false; \
-    (HT)->temp_entry = NULL; \
-    (HT)->count = 0; \
+    (HT)->allocator = ht_allocator; \
+    (HT)->max_load = ES_HASH_TABLE_MAX_LOAD; \
+    _es_hash_table_rehash_impl(_es_hash_table_head(HT), (LAYOUT), _ES_HASH_TABLE_GROUP); \
 } while (0)
 
+// Initialize hash table with memory from an allocator. A NULL allocator allocates from the heap.
+#define es_hash_table_init_allocator(HT, A) _es_hash_table_init_layout(HT, A, _es_hash_table_layout(HT))
+
+// Initialize hash table with memory from an arena.
+#define es_hash_table_init_arena(HT, ARENA) es_hash_table_init_allocator(HT, es_arena_allocator(ARENA))
+
+// Initialize hash table.
+#define _es_hash_table_init(HT) es_hash_table_init_allocator(HT, NULL)
+
 // Hash table uses string as key.
 #define es_hash_table_string_key(HT) do { \
     _es_hash_table_init(HT); \
     (HT)->string_key = true; \
 } while (0)
 
-// Backend insertion into entries
-#define _es_hash_table_insert_entry(COUNT, ENTRIES, HASH, CAP, K, V) do { \
-    usize_t index = (HASH) % (CAP); \
-    usize_t count = 0; \
-    usize_t search_hash = (ENTRIES)[index].hash; \
-    for (;;) { \
-        /* Stop if iteration has surpassed the cap, the hashes match or the entry is dead. */ \
-        if (count >= CAP || search_hash == (HASH) || (ENTRIES)[index].state == _ES_HASH_TABLE_ENTRY_DEAD) { \
-            break; \
-        } \
-        /* Increment. */ \
-        index = (index + 1) % (CAP); \
-        search_hash = (ENTRIES)[index].hash; \
-        count++; \
-    } \
-    /* If it's a new entry, add it to entry count. */ \
-    if ((ENTRIES)[index].state == _ES_HASH_TABLE_ENTRY_DEAD) { \
-        (COUNT)++; \
-    } \
-    /* Initialize the entry. */ \
-    (ENTRIES)[index].key   = (K); \
-    (ENTRIES)[index].value = (V); \
-    (ENTRIES)[index].state = _ES_HASH_TABLE_ENTRY_ALIVE; \
-    (ENTRIES)[index].hash  = (HASH); \
-} while(0)
-
-// Resize hash table when needed.
-#define _es_hash_table_resize(HT) do { \
+// Spread rehashing over the following inserts and removes instead of moving every
+// entry at once. Lookups only read, falling back to the old arrays for keys not yet
+// moved, so a table that is only read from keeps the old arrays until
+// es_hash_table_finish_rehash or the next insert or remove.
+#define es_hash_table_incremental(HT) do { \
     _es_hash_table_init(HT); \
-    es_da(__typeof__(*((HT)->entries))) new_entries = NULL; \
-    usize_t cap = es_da_count((HT)->entries); \
-    /* If entry count is at the capacity limit, resize. */ \
-    if ((HT)->count >= cap * ES_HASH_TABLE_MAX_CAP) { \
-        es_da_push_arr(new_entries, NULL, cap * 2); \
-    } \
-    /* Resize isn't necessary. */ \
-    if (new_entries == NULL) { \
+    (HT)->incremental = true; \
+} while (0)
+
+// Move every entry still waiting on an incremental rehash and free the old arrays.
+#define es_hash_table_finish_rehash(HT) do { \
+    if ((HT) == NULL) { \
         break; \
     } \
-    (HT)->count = 0; \
-    /* Remap every entry into the new entry array. */ \
-    for (usize_t i = 0; i < cap; i++) { \
-        __typeof__(*((HT)->entries)) curr = (HT)->entries[i]; \
-        if (curr.state == _ES_HASH_TABLE_ENTRY_DEAD) { \
-            continue; \
-        } \
-        _es_hash_table_insert_entry((HT)->count, new_entries, curr.hash, es_da_count(new_entries), curr.key, curr.value); \
-    } \
-    /* Free unused arrays. */ \
-    es_da_free((HT)->entries); \
-    /* Update hash table arrays. */ \
-    (HT)->entries = new_entries; \
+    _es_hash_table_finish_rehash_impl(_es_hash_table_head(HT), _es_hash_table_layout(HT)); \
+} while (0)
+
+// Hash keys with FUNC instead of es_siphash, for example es_wyhash for keys that can't be
+// picked to flood the table. Strings keys hash their characters. Table must be empty.
+#define es_hash_table_hash_func(HT, FUNC) do { \
+    _es_hash_table_init(HT); \
+    es_assert((HT)->count == 0, "Can't change the hash function of a hash table holding entries.", NULL); \
+    (HT)->hash_func = (FUNC); \
+} while (0)
+
+// Hash a key stored in a variable.
+#define _es_hash_table_hash(HT, KEY_VAR) _es_hash_table_hash_key((HT)->hash_func, (HT)->string_key, &(KEY_VAR), sizeof(KEY_VAR))
+
+// Make room for at least N entries so inserting them never rehashes.
+#define es_hash_table_reserve(HT, N) do { \
+    _es_hash_table_init(HT); \
+    _es_hash_table_reserve_impl(_es_hash_table_head(HT), _es_hash_table_layout(HT), (N)); \
 } while (0)
 
-// Insert entry into hash table.
+// Set the maximum ratio of alive entries and tombstones to slots before growing, between 0 and 1 exclusive.
+#define es_hash_table_max_load(HT, LOAD) do { \
+    _es_hash_table_init(HT); \
+    f32_t es_ht_load = (LOAD); \
+    es_assert(es_ht_load > 0.0f && es_ht_load < 1.0f, "Hash table max load must be between 0 and 1.", NULL); \
+    (HT)->max_load = es_ht_load; \
+} while (0)
+
+// Insert entry into hash table, replacing the value if the key exists.
 #define es_hash_table_insert(HT, K, V) do { \
-    _es_hash_table_resize(HT); \
+    _es_hash_table_init(HT); \
     __typeof__((HT)->entries->key) es_ht_temp_key = (K); \
-    usize_t hash = _es_hash_table_hash_key((HT)->string_key, (void **) &es_ht_temp_key, sizeof((HT)->temp_key)); \
-    usize_t cap = es_da_count((HT)->entries); \
-    _es_hash_table_insert_entry((HT)->count, (HT)->entries, hash, cap, K, V); \
+    usize_t es_ht_hash = _es_hash_table_hash(HT, es_ht_temp_key); \
+    __typeof__((HT)->entries) es_ht_entry = _es_hash_table_claim_impl( \
+        _es_hash_table_head(HT), \
+        _es_hash_table_layout(HT), \
+        es_ht_hash, \
+        &es_ht_temp_key \
+    ); \
+    es_ht_entry->key   = es_ht_temp_key; \
+    es_ht_entry->value = (V); \
+    es_ht_entry->hash  = es_ht_hash; \
 } while (0)
 
-// Get entry value from hash table.
+// Copy a key into a temporary, leaving the table untouched so several
+// threads can look keys up at once. An array literal also takes struct keys.
+#define _es_hash_table_key_ref(HT, K) ((__typeof__((HT)->entries->key)[1]) { (K) })
+
+// Get entry value from hash table. Missing keys give a zeroed value.
 #define es_hash_table_get(HT, K) ( \
-    (HT)->temp_key = (K), \
-    (HT)->entries[ \
-        _es_hash_table_get_index( \
-        _es_hash_table_hash_key((HT)->string_key, (void **) &(HT)->temp_key, sizeof((HT)->temp_key)), \
-            (void **) &(HT)->entries, \
-            es_da_count((HT)->entries), \
-            sizeof(*(HT)->entries), \
-            es_offset(__typeof__(*(HT)->entries), hash), \
-            es_offset(__typeof__(*(HT)->entries), state) \
-        ) \
-    ].value \
+    ((__typeof__((HT)->entries)) _es_hash_table_get_impl( \
+        _es_hash_table_head(HT), \
+        _es_hash_table_layout(HT), \
+        _es_hash_table_key_ref(HT, K) \
+    ))->value \
+)
+
+// Check if hash table holds a key.
+#define es_hash_table_contains(HT, K) ( \
+    (HT) != NULL && \
+    _es_hash_table_contains_impl( \
+        _es_hash_table_head(HT), \
+        _es_hash_table_layout(HT), \
+        _es_hash_table_key_ref(HT, K) \
+    ) \
 )
 
 // Remove entry from hash table.
@@ -461,74 +1152,348 @@ typedef enum _es_hash_table_entry_state_t {
     if ((HT) == NULL) { \
         break; \
     } \
-    (HT)->temp_key = (K); \
-    (HT)->temp_entry = (__typeof__((HT)->temp_entry)) &(HT)->entries[_es_hash_table_get_index( \
-        _es_hash_table_hash_key((HT)->string_key, (void **) &(HT)->temp_key, sizeof((HT)->temp_key)), \
-        (void **) &(HT)->entries, \
-        es_da_count((HT)->entries), \
-        sizeof(*(HT)->entries), \
-        es_offset(__typeof__(*(HT)->entries), hash), \
-        es_offset(__typeof__(*(HT)->entries), state) \
-    )]; \
-    memset((HT)->temp_entry, 0, sizeof(*(HT)->entries)); \
-    (HT)->count--; \
+    __typeof__((HT)->entries->key) es_ht_temp_key = (K); \
+    _es_hash_table_remove_impl( \
+        _es_hash_table_head(HT), \
+        _es_hash_table_layout(HT), \
+        _es_hash_table_hash(HT, es_ht_temp_key), \
+        &es_ht_temp_key \
+    ); \
 } while (0)
 
-// Reset hash table.
-#define es_hash_table_clear(HT) do { \
-    /* Recreate hash table arrays. */ \
-    __typeof__((HT)->entries) new_entries = NULL; \
-    es_da_push_arr(new_entries, NULL, 8); \
-    es_da_free((HT)->entries); \
-    (HT)->entries = new_entries; \
-    (HT)->count = 0; \
-} while (0)
+// Reset hash table, keeping its capacity.
+#define es_hash_table_clear(HT) _es_hash_table_clear_impl(_es_hash_table_head(HT), _es_hash_table_layout(HT))
 
 // Free allocated memory for hash table.
 #define es_hash_table_free(HT) do { \
     if ((HT) == NULL) { \
         break; \
     } \
-    es_da_free((HT)->entries); \
-    es_free(HT); \
+    _es_hash_table_free_impl(_es_hash_table_head(HT)); \
+    _es_free((HT)->allocator, (HT), sizeof(*(HT))); \
 } while (0) \
 
 // Get entry count in hash table.
 #define es_hash_table_count(HT) (HT)->count
 
-// Hash table iterator type.
+// Hash table iterator type. Starting an iteration finishes any incremental rehash.
 typedef usize_t es_hash_table_iter_t;
-#define es_hash_table_iter_new(HT) _es_hash_table_iter_new_impl( \
-    (HT)->entries, \
-    es_offset(__typeof__(*(HT)->temp_entry), state), \
-    sizeof(__typeof__(*(HT)->temp_entry)), \
-    es_da_count((HT)->entries) \
-)
+#define es_hash_table_iter_new(HT) _es_hash_table_iter_new_impl(_es_hash_table_head(HT), _es_hash_table_layout(HT))
 // Check if the hash table iterator valid.
-#define es_hash_table_iter_valid(HT, IT) ((HT) == NULL ? false : ((IT) < es_da_count((HT)->entries)))
+#define es_hash_table_iter_valid(HT, IT) ((HT) == NULL ? false : ((IT) < _es_hash_table_cap(HT)))
 // Advance hash table iterator.
-#define es_hash_table_iter_advance(HT, IT) _es_hash_table_iter_advance_impl( \
-    es_offset(__typeof__(*(HT)->temp_entry), state), \
-    sizeof(*(HT)->temp_entry), \
-    (void *) (HT)->entries, \
-    &(IT), \
-    es_da_count((HT)->entries) \
-)
+#define es_hash_table_iter_advance(HT, IT) _es_hash_table_iter_advance_impl((HT)->ctrl, &(IT), _es_hash_table_cap(HT))
 // Get value of entry at current iterator index.
 #define es_hash_table_iter_get(HT, IT) (HT)->entries[(IT)].value
 // Get key of entry at current iterator index.
 #define es_hash_table_iter_get_key(HT, IT) (HT)->entries[(IT)].key
 // Remove an entry at iterator index.
-#define es_hash_table_iter_remove(HT, IT) memset(&(HT)->entries[(IT)], 0, sizeof(__typeof__(*(HT)->temp_entry)))
-
-// Get index of entry with wanted_hash. If not found, return a dead entry.
-ES_API usize_t _es_hash_table_get_index(usize_t wanted_hash, void **entries, usize_t entry_count, usize_t entry_size, usize_t hash_offset, usize_t state_offset);
-// Hash a hash table value. This only exists to avoid some compiler warnings.
-ES_API usize_t _es_hash_table_hash_key(b8_t is_string, void **ptr, usize_t len);
+#define es_hash_table_iter_remove(HT, IT) _es_hash_table_remove_index_impl(_es_hash_table_head(HT), _es_hash_table_layout(HT), (IT))
+
+// Get entry holding key, or NULL if missing.
+ES_API void *_es_hash_table_lookup_impl(const _es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t hash, const void *key);
+// Get entry holding key, or the zeroed entry past the capacity if missing.
+ES_API void *_es_hash_table_get_impl(const _es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, const void *key);
+ES_API void _es_hash_table_finish_rehash_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout);
+// Check if key is held, hashing it with the table's hash function.
+ES_API b8_t _es_hash_table_contains_impl(const _es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, const void *key);
+// Get entry holding key, growing and claiming a new slot if missing.
+ES_API void *_es_hash_table_claim_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t hash, const void *key);
+// Remove entry holding key.
+ES_API void _es_hash_table_remove_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t hash, const void *key);
+// Remove alive entry at index.
+ES_API void _es_hash_table_remove_index_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t index);
+// Move every entry into new arrays with cap slots, finishing any incremental rehash.
+ES_API void _es_hash_table_rehash_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t cap);
+// Grow to fit at least count entries.
+ES_API void _es_hash_table_reserve_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t count);
+// Remove every entry.
+ES_API void _es_hash_table_clear_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout);
+// Free entry and control arrays.
+ES_API void _es_hash_table_free_impl(_es_hash_table_head_t *ht);
+// Get the smallest power of two slot count holding count entries below max_load.
+ES_API usize_t _es_hash_table_cap_for(usize_t count, f32_t max_load);
+// Hash a key with func, or es_siphash if NULL. String keys hash the string they point to.
+ES_API usize_t _es_hash_table_hash_key(es_hash_func_t func, b8_t is_string, const void *key, usize_t len);
 // Get the first alive entry to start iteration.
-ES_API usize_t _es_hash_table_iter_new_impl(void *entries, usize_t state_stride, usize_t entry_size, usize_t cap);
+ES_API usize_t _es_hash_table_iter_new_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout);
 // Skip all dead entries, advancing the iteration.
-ES_API void _es_hash_table_iter_advance_impl(usize_t state_stride, usize_t entry_size, const void *entries, usize_t *iter, usize_t cap);
+ES_API void _es_hash_table_iter_advance_impl(const u8_t *ctrl, usize_t *iter, usize_t cap);
+
+//
+// Hash set
+//
+
+// Create set entry struct from key. Set entries don't store their hash.
+#define _es_hash_set_entry(K) struct { \
+    K key; \
+}
+
+// Create hash set struct from key. Runs on the hash table engine without storing values or hashes.
+#define es_hash_set(K) struct { \
+    es_da(_es_hash_set_entry(K)) entries; \
+    es_da(u8_t) ctrl; \
+    usize_t count; \
+    usize_t tombstones; \
+    f32_t max_load; \
+    b8_t string_key; \
+    b8_t incremental; \
+    const es_allocator_t *allocator; \
+    es_da(_es_hash_set_entry(K)) old_entries; \
+    es_da(u8_t) old_ctrl; \
+    usize_t migrated; \
+    es_hash_func_t hash_func; \
+    _es_hash_set_entry(K) *temp_entry; \
+} *
+
+// Describe the entry layout of a hash set.
+#define _es_hash_set_layout(HS) (&(const _es_hash_table_layout_t) { \
+    sizeof(*(HS)->entries), \
+    0, \
+    sizeof((HS)->entries->key), \
+    0, \
+    0, \
+    _ES_HASH_TABLE_NO_HASH, \
+    (HS)->string_key, \
+})
+
+// Initialize hash set with memory from an allocator. A NULL allocator allocates from the heap.
+#define es_hash_set_init_allocator(HS, A) _es_hash_table_init_layout(HS, A, _es_hash_set_layout(HS))
+// Initialize hash set with memory from an arena.
+#define es_hash_set_init_arena(HS, ARENA) es_hash_set_init_allocator(HS, es_arena_allocator(ARENA))
+// Initialize hash set.
+#define _es_hash_set_init(HS) es_hash_set_init_allocator(HS, NULL)
+
+// Hash set uses string as key.
+#define es_hash_set_string_key(HS) do { \
+    _es_hash_set_init(HS); \
+    (HS)->string_key = true; \
+} while (0)
+
+// Spread rehashing over the following operations instead of moving every key at once.
+#define es_hash_set_incremental(HS) do { \
+    _es_hash_set_init(HS); \
+    (HS)->incremental = true; \
+} while (0)
+
+// Hash keys with FUNC instead of es_siphash. Set must be empty.
+#define es_hash_set_hash_func(HS, FUNC) do { \
+    _es_hash_set_init(HS); \
+    es_assert((HS)->count == 0, "Can't change the hash function of a hash set holding keys.", NULL); \
+    (HS)->hash_func = (FUNC); \
+} while (0)
+
+// Make room for at least N keys so inserting them never rehashes.
+#define es_hash_set_reserve(HS, N) do { \
+    _es_hash_set_init(HS); \
+    _es_hash_table_reserve_impl(_es_hash_table_head(HS), _es_hash_set_layout(HS), (N)); \
+} while (0)
+
+// Set the maximum ratio of alive keys and tombstones to slots before growing, between 0 and 1 exclusive.
+#define es_hash_set_max_load(HS, LOAD) do { \
+    _es_hash_set_init(HS); \
+    f32_t es_hs_load = (LOAD); \
+    es_assert(es_hs_load > 0.0f && es_hs_load < 1.0f, "Hash set max load must be between 0 and 1.", NULL); \
+    (HS)->max_load = es_hs_load; \
+} while (0)
+
+// Insert key into hash set.
+#define es_hash_set_insert(HS, K) do { \
+    _es_hash_set_init(HS); \
+    __typeof__((HS)->entries->key) es_hs_temp_key = (K); \
+    __typeof__((HS)->entries) es_hs_entry = _es_hash_table_claim_impl( \
+        _es_hash_table_head(HS), \
+        _es_hash_set_layout(HS), \
+        _es_hash_table_hash(HS, es_hs_temp_key), \
+        &es_hs_temp_key \
+    ); \
+    es_hs_entry->key = es_hs_temp_key; \
+} while (0)
+
+// Check if hash set holds a key.
+#define es_hash_set_contains(HS, K) ( \
+    (HS) != NULL && \
+    _es_hash_table_contains_impl( \
+        _es_hash_table_head(HS), \
+        _es_hash_set_layout(HS), \
+        _es_hash_table_key_ref(HS, K) \
+    ) \
+)
+
+// Remove key from hash set.
+#define es_hash_set_remove(HS, K) do { \
+    if ((HS) == NULL) { \
+        break; \
+    } \
+    __typeof__((HS)->entries->key) es_hs_temp_key = (K); \
+    _es_hash_table_remove_impl( \
+        _es_hash_table_head(HS), \
+        _es_hash_set_layout(HS), \
+        _es_hash_table_hash(HS, es_hs_temp_key), \
+        &es_hs_temp_key \
+    ); \
+} while (0)
+
+// Reset hash set, keeping its capacity.
+#define es_hash_set_clear(HS) _es_hash_table_clear_impl(_es_hash_table_head(HS), _es_hash_set_layout(HS))
+// Free allocated memory for hash set.
+#define es_hash_set_free(HS) es_hash_table_free(HS)
+// Get key count in hash set.
+#define es_hash_set_count(HS) (HS)->count
+
+// Hash set iterator type. Starting an iteration finishes any incremental rehash.
+typedef usize_t es_hash_set_iter_t;
+#define es_hash_set_iter_new(HS) _es_hash_table_iter_new_impl(_es_hash_table_head(HS), _es_hash_set_layout(HS))
+// Check if the hash set iterator valid.
+#define es_hash_set_iter_valid(HS, IT) es_hash_table_iter_valid(HS, IT)
+// Advance hash set iterator.
+#define es_hash_set_iter_advance(HS, IT) es_hash_table_iter_advance(HS, IT)
+// Get key at current iterator index.
+#define es_hash_set_iter_get(HS, IT) (HS)->entries[(IT)].key
+// Remove key at iterator index.
+#define es_hash_set_iter_remove(HS, IT) _es_hash_table_remove_index_impl(_es_hash_table_head(HS), _es_hash_set_layout(HS), (IT))
+
+//
+// Hash multimap
+//
+
+// Where the values of a multimap key live in the value array.
+typedef struct _es_hash_multimap_run_t {
+    usize_t start;
+    usize_t count;
+    usize_t cap;
+} _es_hash_multimap_run_t;
+
+// Create hash multimap struct from key and value. Values of a key are stored
+// contiguously in insertion order. Runs which outgrow their capacity move to
+// the end of the value array, and the gaps left behind are compacted away
+// once they outnumber the values.
+#define es_hash_multimap(K, V) struct { \
+    es_hash_table(K, _es_hash_multimap_run_t) keys; \
+    es_da(V) values; \
+    usize_t count; \
+    usize_t holes; \
+}
+
+// Initialize hash multimap with memory from an allocator. A NULL allocator allocates from the heap.
+#define es_hash_multimap_init_allocator(MM, A) do { \
+    if ((MM).keys != NULL) { \
+        break; \
+    } \
+    const es_allocator_t *mm_allocator = (A); \
+    es_hash_table_init_allocator((MM).keys, mm_allocator); \
+    es_da_init_allocator((MM).values, mm_allocator); \
+} while (0)
+
+// Initialize hash multimap with memory from an arena.
+#define es_hash_multimap_init_arena(MM, ARENA) es_hash_multimap_init_allocator(MM, es_arena_allocator(ARENA))
+
+// Initialize hash multimap.
+#define _es_hash_multimap_init(MM) es_hash_multimap_init_allocator(MM, NULL)
+
+// Hash multimap uses string as key.
+#define es_hash_multimap_string_key(MM) do { \
+    _es_hash_multimap_init(MM); \
+    (MM).keys->string_key = true; \
+} while (0)
+
+// Add a value after the existing values of a key.
+#define es_hash_multimap_insert(MM, K, V) do { \
+    _es_hash_multimap_init(MM); \
+    __typeof__((MM).keys->entries->key) es_mm_temp_key = (K); \
+    usize_t es_mm_index = 0; \
+    (MM).values = (__typeof__((MM).values)) _es_hash_multimap_push_impl( \
+        _es_hash_table_head((MM).keys), \
+        _es_hash_table_layout((MM).keys), \
+        (MM).values, \
+        &(MM).count, \
+        &(MM).holes, \
+        _es_hash_table_hash((MM).keys, es_mm_temp_key), \
+        &es_mm_temp_key, \
+        &es_mm_index \
+    ); \
+    (MM).values[es_mm_index] = (V); \
+} while (0)
+
+// Get the values of a key and store their amount in COUNT_PTR. Missing keys give NULL and 0.
+// Pointer is valid until the next insert.
+#define es_hash_multimap_get(MM, K, COUNT_PTR) ( \
+    (MM).keys == NULL ? (*(COUNT_PTR) = 0, (__typeof__((MM).values)) NULL) : \
+    (__typeof__((MM).values)) _es_hash_multimap_get_impl( \
+        _es_hash_table_head((MM).keys), \
+        _es_hash_table_layout((MM).keys), \
+        (MM).values, \
+        _es_hash_table_key_ref((MM).keys, K), \
+        (COUNT_PTR) \
+    ) \
+)
+
+// Check if hash multimap holds a key.
+#define es_hash_multimap_contains(MM, K) es_hash_table_contains((MM).keys, K)
+
+// Remove a key and every value of it.
+#define es_hash_multimap_remove(MM, K) do { \
+    if ((MM).keys == NULL) { \
+        break; \
+    } \
+    __typeof__((MM).keys->entries->key) es_mm_temp_key = (K); \
+    _es_hash_multimap_remove_impl( \
+        _es_hash_table_head((MM).keys), \
+        _es_hash_table_layout((MM).keys), \
+        &(MM).count, \
+        &(MM).holes, \
+        _es_hash_table_hash((MM).keys, es_mm_temp_key), \
+        &es_mm_temp_key \
+    ); \
+} while (0)
+
+// Remove every key and value, keeping the capacity.
+#define es_hash_multimap_clear(MM) do { \
+    if ((MM).keys == NULL) { \
+        break; \
+    } \
+    es_hash_table_clear((MM).keys); \
+    es_da_clear((MM).values); \
+    (MM).count = 0; \
+    (MM).holes = 0; \
+} while (0)
+
+// Free allocated memory for hash multimap.
+#define es_hash_multimap_free(MM) do { \
+    es_hash_table_free((MM).keys); \
+    es_da_free((MM).values); \
+    (MM).keys = NULL; \
+    (MM).count = 0; \
+    (MM).holes = 0; \
+} while (0)
+
+// Get value count in hash multimap.
+#define es_hash_multimap_count(MM) (MM).count
+// Get key count in hash multimap.
+#define es_hash_multimap_key_count(MM) ((MM).keys == NULL ? 0 : (MM).keys->count)
+
+// Hash multimap iterator type, visiting every key once.
+typedef usize_t es_hash_multimap_iter_t;
+#define es_hash_multimap_iter_new(MM) ((MM).keys == NULL ? 0 : es_hash_table_iter_new((MM).keys))
+// Check if the hash multimap iterator valid.
+#define es_hash_multimap_iter_valid(MM, IT) es_hash_table_iter_valid((MM).keys, IT)
+// Advance hash multimap iterator.
+#define es_hash_multimap_iter_advance(MM, IT) es_hash_table_iter_advance((MM).keys, IT)
+// Get key at current iterator index.
+#define es_hash_multimap_iter_get_key(MM, IT) (MM).keys->entries[(IT)].key
+// Get values at current iterator index and store their amount in COUNT_PTR.
+#define es_hash_multimap_iter_get(MM, IT, COUNT_PTR) ( \
+    *(COUNT_PTR) = (MM).keys->entries[(IT)].value.count, \
+    (MM).values + (MM).keys->entries[(IT)].value.start \
+)
+
+// Claim a slot after the values of key, claiming the key if missing. Stores the value index in index.
+// Returns the value array, which may have moved.
+ES_API void *_es_hash_multimap_push_impl(_es_hash_table_head_t *keys, const _es_hash_table_layout_t *layout, void *values, usize_t *count, usize_t *holes, usize_t hash, const void *key, usize_t *index);
+// Get the first value of key and store the amount of values in count.
+ES_API void *_es_hash_multimap_get_impl(_es_hash_table_head_t *keys, const _es_hash_table_layout_t *layout, void *values, const void *key, usize_t *count);
+// Remove key and its values.
+ES_API void _es_hash_multimap_remove_impl(_es_hash_table_head_t *keys, const _es_hash_table_layout_t *layout, usize_t *count, usize_t *holes, usize_t hash, const void *key);
 
 /*=========================*/
 // Threading
@@ -554,6 +1519,192 @@ ES_API void es_mutex_free(es_mutex_t *mutex);
 ES_API void es_mutex_lock(es_mutex_t *mutex);
 ES_API void es_mutex_unlock(es_mutex_t *mutex);
 
+/*=========================*/
+// Pool
+/*=========================*/
+
+// Default amount of blocks allocated per slab.
+#ifndef ES_POOL_SLAB_BLOCKS
+#define ES_POOL_SLAB_BLOCKS 64
+#endif // ES_POOL_SLAB_BLOCKS
+
+// Amount of blocks a pool cache can hold.
+#ifndef ES_POOL_CACHE_SIZE
+#define ES_POOL_CACHE_SIZE 32
+#endif // ES_POOL_CACHE_SIZE
+
+// Alignment of every pool block.
+#define ES_POOL_ALIGNMENT 16
+
+// Free block, linked in place inside the unused memory.
+typedef struct _es_pool_block_t {
+    struct _es_pool_block_t *next;
+} _es_pool_block_t;
+
+// Header struct placed before every slab of blocks.
+typedef struct _es_pool_slab_t {
+    struct _es_pool_slab_t *prev;
+} _es_pool_slab_t;
+
+// Allocator handing out fixed size blocks.
+typedef struct es_pool_t {
+    // Blocks ready to be handed out.
+    _es_pool_block_t *free_list;
+    // Latest allocated slab.
+    _es_pool_slab_t *slab;
+    // Size of every block.
+    usize_t block_size;
+    // Amount of blocks in every slab.
+    usize_t slab_blocks;
+    // Guards the free list when used from multiple threads.
+    es_mutex_t mutex;
+    // Allocator interface handed out by es_pool_allocator.
+    es_allocator_t allocator;
+} es_pool_t;
+
+// Thread owned magazine of blocks, refilled from and flushed to a pool in batches.
+typedef struct es_pool_cache_t {
+    es_pool_t *pool;
+    void *blocks[ES_POOL_CACHE_SIZE];
+    usize_t count;
+} es_pool_cache_t;
+
+// Align a size to the pool alignment.
+#define _es_pool_align(S) (((S) + (ES_POOL_ALIGNMENT - 1)) & ~((usize_t) ES_POOL_ALIGNMENT - 1))
+// Get the first block of a slab.
+#define _es_pool_slab_ptr(S) ((u8_t *) (S) + _es_pool_align(sizeof(_es_pool_slab_t)))
+
+// Create a pool. A slab block count of 0 uses ES_POOL_SLAB_BLOCKS.
+ES_API es_pool_t es_pool_init(usize_t block_size, usize_t slab_blocks);
+// Free every slab owned by pool.
+ES_API void es_pool_free(es_pool_t *pool);
+// Get a block from pool.
+ES_API void *es_pool_alloc(es_pool_t *pool);
+// Give a block back to pool.
+ES_API void es_pool_release(es_pool_t *pool, void *ptr);
+// Get an allocator interface for pool. Allocations can't exceed the block size.
+ES_API const es_allocator_t *es_pool_allocator(es_pool_t *pool);
+// Allocate a new slab and add its blocks to the free list. Pool must be locked.
+ES_API void _es_pool_grow(es_pool_t *pool);
+
+// Pool allocator callbacks.
+ES_API void *_es_pool_allocator_alloc(usize_t size, void *user);
+ES_API void *_es_pool_allocator_realloc(void *ptr, usize_t old_size, usize_t new_size, void *user);
+ES_API void _es_pool_allocator_free(void *ptr, usize_t size, void *user);
+
+// Create a cache for the calling thread.
+ES_API es_pool_cache_t es_pool_cache_init(es_pool_t *pool);
+// Return every cached block to the pool.
+ES_API void es_pool_cache_flush(es_pool_cache_t *cache);
+// Get a block without locking unless the cache is empty.
+ES_API void *es_pool_cache_alloc(es_pool_cache_t *cache);
+// Give a block back without locking unless the cache is full.
+ES_API void es_pool_cache_release(es_pool_cache_t *cache, void *ptr);
+
+/*=========================*/
+// Concurrent hash table
+/*=========================*/
+
+// Amount of independently locked shards, as a power of two.
+#ifndef ES_CHASH_TABLE_SHARD_BITS
+#define ES_CHASH_TABLE_SHARD_BITS 4
+#endif // ES_CHASH_TABLE_SHARD_BITS
+#define ES_CHASH_TABLE_SHARDS (1 << ES_CHASH_TABLE_SHARD_BITS)
+
+// One lock striped part of a concurrent hash table.
+typedef struct _es_chash_table_shard_t {
+    _es_hash_table_head_t table;
+    es_mutex_t mutex;
+} _es_chash_table_shard_t;
+
+// Update a value in place. Value is zeroed when the key didn't exist.
+typedef void (*es_chash_table_upsert_func_t)(void *value, b8_t exists, void *user);
+
+// Create concurrent hash table struct from key and value. Every operation
+// works on copies of keys and values so nothing shared is used as scratch.
+#define es_chash_table(K, V) struct { \
+    _es_chash_table_shard_t shards[ES_CHASH_TABLE_SHARDS]; \
+    b8_t string_key; \
+    const es_allocator_t *allocator; \
+    _es_hash_table_entry(K, V) *_entry; \
+} *
+
+// Describe the entry layout of a concurrent hash table.
+#define _es_chash_table_layout(HT) _es_hash_table_layout_of((HT)->_entry, (HT)->string_key)
+// Copy a key or value into a temporary array so it can be passed by pointer.
+#define _es_chash_table_key_ptr(HT, K) ((__typeof__((HT)->_entry->key)[1]) { (K) })
+#define _es_chash_table_value_ptr(HT, V) ((__typeof__((HT)->_entry->value)[1]) { (V) })
+
+// Initialize concurrent hash table with memory from an allocator. Must be done before sharing it.
+#define es_chash_table_init_allocator(HT, A, STRING_KEY) do { \
+    const es_allocator_t *ht_allocator = (A); \
+    (HT) = _es_alloc(ht_allocator, sizeof(*(HT))); \
+    memset((HT), 0, sizeof(*(HT))); \
+    (HT)->allocator = ht_allocator; \
+    (HT)->string_key = (STRING_KEY); \
+    _es_chash_table_init_impl((HT)->shards, _es_chash_table_layout(HT), ht_allocator); \
+} while (0)
+// Initialize concurrent hash table on the heap. Must be done before sharing it.
+#define es_chash_table_init(HT) es_chash_table_init_allocator(HT, NULL, false)
+// Initialize concurrent hash table using strings as keys on the heap.
+#define es_chash_table_init_string_key(HT) es_chash_table_init_allocator(HT, NULL, true)
+
+// Free allocated memory for concurrent hash table.
+#define es_chash_table_free(HT) do { \
+    if ((HT) == NULL) { \
+        break; \
+    } \
+    _es_chash_table_free_impl((HT)->shards); \
+    _es_free((HT)->allocator, (HT), sizeof(*(HT))); \
+} while (0)
+
+// Insert entry, replacing the value if the key exists.
+#define es_chash_table_insert(HT, K, V) _es_chash_table_insert_impl( \
+    (HT)->shards, \
+    _es_chash_table_layout(HT), \
+    _es_chash_table_key_ptr(HT, K), \
+    _es_chash_table_value_ptr(HT, V) \
+)
+// Copy value of entry into OUT. Evaluates to false if the key is missing.
+#define es_chash_table_get(HT, K, OUT) _es_chash_table_get_impl( \
+    (HT)->shards, \
+    _es_chash_table_layout(HT), \
+    _es_chash_table_key_ptr(HT, K), \
+    (1 ? (OUT) : &(HT)->_entry->value) \
+)
+// Check if concurrent hash table holds a key.
+#define es_chash_table_contains(HT, K) es_chash_table_get(HT, K, NULL)
+// Remove entry. Evaluates to false if the key is missing.
+#define es_chash_table_remove(HT, K) _es_chash_table_remove_impl( \
+    (HT)->shards, \
+    _es_chash_table_layout(HT), \
+    _es_chash_table_key_ptr(HT, K) \
+)
+// Insert or update entry in place with FUNC while holding its lock.
+#define es_chash_table_upsert(HT, K, FUNC, USER) _es_chash_table_upsert_impl( \
+    (HT)->shards, \
+    _es_chash_table_layout(HT), \
+    _es_chash_table_key_ptr(HT, K), \
+    (FUNC), \
+    (USER) \
+)
+// Make room for at least N entries across every shard.
+#define es_chash_table_reserve(HT, N) _es_chash_table_reserve_impl((HT)->shards, _es_chash_table_layout(HT), (N))
+// Get entry count. Only exact while no other thread is writing.
+#define es_chash_table_count(HT) _es_chash_table_count_impl((HT)->shards)
+// Hash keys with FUNC instead of es_siphash. Must be set before any entry is inserted.
+#define es_chash_table_hash_func(HT, FUNC) _es_chash_table_hash_func_impl((HT)->shards, (FUNC))
+
+ES_API void _es_chash_table_init_impl(_es_chash_table_shard_t *shards, const _es_hash_table_layout_t *layout, const es_allocator_t *allocator);
+ES_API void _es_chash_table_free_impl(_es_chash_table_shard_t *shards);
+ES_API void _es_chash_table_insert_impl(_es_chash_table_shard_t *shards, const _es_hash_table_layout_t *layout, const void *key, const void *value);
+ES_API b8_t _es_chash_table_get_impl(_es_chash_table_shard_t *shards, const _es_hash_table_layout_t *layout, const void *key, void *out);
+ES_API b8_t _es_chash_table_remove_impl(_es_chash_table_shard_t *shards, const _es_hash_table_layout_t *layout, const void *key);
+ES_API void _es_chash_table_upsert_impl(_es_chash_table_shard_t *shards, const _es_hash_table_layout_t *layout, const void *key, es_chash_table_upsert_func_t func, void *user);
+ES_API void _es_chash_table_reserve_impl(_es_chash_table_shard_t *shards, const _es_hash_table_layout_t *layout, usize_t count);
+ES_API usize_t _es_chash_table_count_impl(_es_chash_table_shard_t *shards);
+ES_API void _es_chash_table_hash_func_impl(_es_chash_table_shard_t *shards, es_hash_func_t func);
+
 /*=========================*/
 // Strings
 /*=========================*/
@@ -561,12 +1712,28 @@ ES_API void es_mutex_unlock(es_mutex_t *mutex);
 #define _es_str_head(P) ((_es_str_head_t *) ((u8_t *) P - sizeof(_es_str_head_t)))
 #define _es_str_ptr(H) ((es_str_t) ((u8_t *) H + sizeof(_es_str_head_t)))
 
+// Minimum capacity of a string which has to grow.
+#define _ES_STR_MIN_CAP 15
+
 typedef struct {
     usize_t len;
+    // Characters which fit before reallocating, not counting the terminator.
+    usize_t cap;
     b8_t valid;
+    const es_allocator_t *allocator;
 } _es_str_head_t;
 typedef char *es_str_t;
 
+// Non owning view of characters, which aren't necessarily terminated.
+typedef struct es_strview_t {
+    const char *data;
+    usize_t len;
+} es_strview_t;
+
+ES_API es_str_t es_strn_allocator(const char *str, usize_t len, const es_allocator_t *allocator);
+ES_API es_str_t es_str_allocator(const char *str, const es_allocator_t *allocator);
+ES_API es_str_t es_strn_arena(const char *str, usize_t len, es_arena_t *arena);
+ES_API es_str_t es_str_arena(const char *str, es_arena_t *arena);
 ES_API es_str_t es_strn(const char *str, usize_t len);
 ES_API es_str_t es_str(const char *str);
 ES_API es_str_t es_str_empty(void);
@@ -582,17 +1749,23 @@ ES_API es_str_t es_str_i32(i32_t value);
 ES_API es_str_t es_str_i16(i16_t value);
 ES_API es_str_t es_str_i8(i8_t value);
 
+// Short text which parses back to exactly value, see es_f64_to_buf.
+ES_API es_str_t es_str_f64(f64_t value);
+
 ES_API es_str_t es_str_b8(b8_t value);
+ES_API es_str_t es_str_view(es_strview_t view);
 
 ES_API void es_str_free(es_str_t *str);
 ES_API void es_str_free_list(es_da(es_str_t) *list);
 
 ES_API b8_t es_str_valid(const es_str_t str);
 ES_API usize_t es_str_len(const es_str_t str);
+ES_API usize_t es_str_cap(const es_str_t str);
 
 ES_API void es_str_concat_len(es_str_t *str, const char *end, usize_t len);
 ES_API void es_str_concat(es_str_t *str, const char *end);
 ES_API void es_str_concat_char(es_str_t *str, char c);
+ES_API void es_str_concat_view(es_str_t *str, es_strview_t view);
 
 ES_API void es_str_reverse(es_str_t *str);
 
@@ -602,12 +1775,17 @@ ES_API es_str_t es_str_sub_index(const char *str, usize_t start, usize_t end);
 ES_API es_str_t es_str_sub_len(const char *str, usize_t start, usize_t len);
 
 ES_API es_da(es_str_t) es_str_split_by_delim(const char *str, char delim);
+ES_API void es_str_split_by_delim_into(es_da(es_str_t) *list, const char *str, char delim);
 
 ES_API i32_t es_str_cmp(es_str_t str, const char *b);
 
+// Grow length by len, growing the capacity geometrically when needed.
 ES_API void _es_str_resize(es_str_t *str, usize_t len);
+// Make room for cap characters without changing the length.
+ES_API void _es_str_reserve(es_str_t *str, usize_t cap);
 
 ES_API usize_t es_cstr_len(const char *str);
+// Compare at most len characters, stopping at the first difference or terminator.
 ES_API i32_t es_cstr_cmp_len(const char *a, const char *b, usize_t len);
 ES_API i32_t es_cstr_cmp(const char *a, const char *b);
 
@@ -615,6 +1793,204 @@ ES_API b8_t es_is_whitespace(char c);
 ES_API b8_t es_is_alpha(char c);
 ES_API b8_t es_is_digit(char c);
 
+//
+// String builder
+//
+
+// Builds a string piece by piece. Finishing hands over the buffer without copying it.
+typedef struct es_str_builder_t {
+    es_str_t str;
+} es_str_builder_t;
+
+// Create an empty builder allocating from allocator. A NULL allocator allocates from the heap.
+ES_API es_str_builder_t es_str_builder_allocator(const es_allocator_t *allocator);
+// Create an empty builder allocating from the heap.
+ES_API es_str_builder_t es_str_builder(void);
+// Make room for len more characters.
+ES_API void es_str_builder_reserve(es_str_builder_t *builder, usize_t len);
+ES_API void es_str_builder_append_len(es_str_builder_t *builder, const char *str, usize_t len);
+ES_API void es_str_builder_append(es_str_builder_t *builder, const char *str);
+ES_API void es_str_builder_append_char(es_str_builder_t *builder, char c);
+ES_API void es_str_builder_append_view(es_str_builder_t *builder, es_strview_t view);
+// Append printf style formatted text.
+ES_API void es_str_builder_appendf(es_str_builder_t *builder, const char *fmt, ...);
+ES_API usize_t es_str_builder_len(const es_str_builder_t *builder);
+// Get the built string. Builder is left empty and can't be used again until recreated.
+ES_API es_str_t es_str_builder_finish(es_str_builder_t *builder);
+// Free a builder without finishing it.
+ES_API void es_str_builder_free(es_str_builder_t *builder);
+
+//
+// String view
+//
+
+// View a string literal without measuring it.
+#define es_strview_lit(LIT) ((es_strview_t) { (LIT), sizeof(LIT) - 1 })
+
+// Splits a view at every delimiter, keeping empty fields.
+typedef struct es_strview_split_t {
+    es_strview_t rest;
+    char delim;
+    b8_t done;
+} es_strview_split_t;
+
+// Splits a view at any of a set of delimiters, skipping empty tokens.
+typedef struct es_strview_tokenizer_t {
+    es_strview_t rest;
+    es_strview_t delims;
+} es_strview_tokenizer_t;
+
+ES_API es_strview_t es_strview(const char *str);
+ES_API es_strview_t es_strview_len(const char *str, usize_t len);
+ES_API es_strview_t es_strview_str(const es_str_t str);
+
+// Get len characters from start. Out of range parts are cut off.
+ES_API es_strview_t es_strview_sub(es_strview_t view, usize_t start, usize_t len);
+// Drop len characters from the start.
+ES_API es_strview_t es_strview_skip(es_strview_t view, usize_t len);
+
+ES_API i32_t es_strview_cmp(es_strview_t a, es_strview_t b);
+ES_API b8_t es_strview_eq(es_strview_t a, es_strview_t b);
+ES_API b8_t es_strview_eq_cstr(es_strview_t view, const char *str);
+ES_API b8_t es_strview_starts_with(es_strview_t view, es_strview_t prefix);
+ES_API b8_t es_strview_ends_with(es_strview_t view, es_strview_t suffix);
+
+// Get index of the first c. Returns view.len if missing.
+ES_API usize_t es_strview_find_char(es_strview_t view, char c);
+// Get index of the first occurance of needle. Returns view.len if missing.
+ES_API usize_t es_strview_find(es_strview_t view, es_strview_t needle);
+// Get index of the first character found in set. Returns view.len if missing.
+ES_API usize_t es_strview_find_any(es_strview_t view, es_strview_t set);
+
+ES_API es_strview_t es_strview_trim(es_strview_t view);
+ES_API es_strview_t es_strview_trim_start(es_strview_t view);
+ES_API es_strview_t es_strview_trim_end(es_strview_t view);
+
+ES_API es_strview_split_t es_strview_split(es_strview_t view, char delim);
+// Get the next field. Returns false once every field has been visited.
+ES_API b8_t es_strview_split_next(es_strview_split_t *split, es_strview_t *field);
+// Push every field of view into list.
+ES_API void es_strview_split_into(es_da(es_strview_t) *list, es_strview_t view, char delim);
+
+ES_API es_strview_tokenizer_t es_strview_tokenizer(es_strview_t view, es_strview_t delims);
+// Get the next non empty token. Returns false when there are no more.
+ES_API b8_t es_strview_tokenizer_next(es_strview_tokenizer_t *tokenizer, es_strview_t *token);
+
+//
+// Small string
+//
+
+// Most characters a small string stores without allocating.
+#define ES_SSTR_CAP 22
+
+// Tag of a small string whose characters live on the heap.
+#define _ES_SSTR_LARGE 0xff
+
+// String value type keeping up to ES_SSTR_CAP characters inline and moving to
+// the heap when it grows past that. Both layouts start with a tag holding the
+// inline length or _ES_SSTR_LARGE. A zeroed small string is empty.
+typedef union es_sstr_t {
+    struct {
+        u8_t tag;
+        char data[ES_SSTR_CAP + 1];
+    } small;
+    struct {
+        u8_t tag;
+        // Heap capacity is a power of two, including the terminator.
+        u8_t cap_log2;
+        char *data;
+        usize_t len;
+    } large;
+} es_sstr_t;
+
+// Strings which can't be allocated come back empty.
+ES_API es_sstr_t es_sstrn(const char *str, usize_t len);
+ES_API es_sstr_t es_sstr(const char *str);
+ES_API es_sstr_t es_sstr_view(es_strview_t view);
+ES_API es_sstr_t es_sstr_u64(u64_t value);
+ES_API es_sstr_t es_sstr_i64(i64_t value);
+ES_API es_sstr_t es_sstr_f64(f64_t value);
+ES_API es_sstr_t es_sstr_b8(b8_t value);
+// Free heap storage, leaving an empty string.
+ES_API void es_sstr_free(es_sstr_t *str);
+
+ES_API usize_t es_sstr_len(const es_sstr_t *str);
+ES_API b8_t es_sstr_is_inline(const es_sstr_t *str);
+// Get terminated characters. Inline characters move along with the string.
+ES_API const char *es_sstr_cstr(const es_sstr_t *str);
+ES_API es_strview_t es_strview_sstr(const es_sstr_t *str);
+ES_API i32_t es_sstr_cmp(const es_sstr_t *str, const char *b);
+
+// Append characters, which may come from str itself. Returns false, leaving
+// str unchanged, when memory runs out.
+ES_API b8_t es_sstr_append_len(es_sstr_t *str, const char *end, usize_t len);
+ES_API b8_t es_sstr_append(es_sstr_t *str, const char *end);
+ES_API b8_t es_sstr_append_char(es_sstr_t *str, char c);
+
+//
+// Number conversion
+//
+
+// Buffer sizes fitting any converted number and its terminator.
+#define ES_U64_BUF_SIZE 21
+#define ES_I64_BUF_SIZE 21
+#define ES_F64_BUF_SIZE 32
+
+// Write the decimal digits of value into buf and terminate them. Returns the length.
+ES_API usize_t es_u64_to_buf(u64_t value, char *buf);
+ES_API usize_t es_i64_to_buf(i64_t value, char *buf);
+// Write a decimal which parses back to exactly value into buf and terminate it.
+// Digits are the shortest possible for all but rare values, which get one more.
+// Uses exponent notation outside 1e-6 to 1e21 like JavaScript.
+ES_API usize_t es_f64_to_buf(f64_t value, char *buf);
+
+// Parse a number from the start of str. Returns the amount of characters used,
+// or 0 if str doesn't start with a number or it doesn't fit.
+ES_API usize_t es_parse_u64(es_strview_t str, u64_t *value);
+ES_API usize_t es_parse_i64(es_strview_t str, i64_t *value);
+// Also parses inf, infinity and nan. Results are correctly rounded. Inputs
+// with more than 19 significant digits that land too close to the halfway
+// point between two doubles go through strtod, which allocates a copy when
+// the input is over 127 characters.
+ES_API usize_t es_parse_f64(es_strview_t str, f64_t *value);
+
+/*=========================*/
+// String interning
+/*=========================*/
+
+// Id of a string which hasn't been interned.
+#define ES_INTERN_NONE 0
+
+// Maps strings to compact ids and canonical pointers. Interned strings are
+// equal exactly when their ids are. A zeroed interner is ready to use.
+typedef struct es_intern_t {
+    // Memory of every interned string.
+    es_arena_t arena;
+    // Canonical string of every id. Slot 0 belongs to ES_INTERN_NONE.
+    es_da(const char *) strings;
+    // Id of every interned string.
+    es_hash_table(const char *, u32_t) ids;
+} es_intern_t;
+
+// Create an empty interner.
+ES_API es_intern_t es_intern_init(void);
+// Free interner and every string interned in it.
+ES_API void es_intern_free(es_intern_t *intern);
+// Get the id of str, interning it if it's new.
+ES_API u32_t es_intern(es_intern_t *intern, const char *str);
+// Get the id of the first len characters of str, interning them if they're new.
+ES_API u32_t es_intern_len(es_intern_t *intern, const char *str, usize_t len);
+// Get the id of a view, interning it if it's new.
+ES_API u32_t es_intern_view(es_intern_t *intern, es_strview_t view);
+// Get the id of str without interning it. Returns ES_INTERN_NONE if it hasn't been interned.
+ES_API u32_t es_intern_find(const es_intern_t *intern, const char *str);
+// Get the id of the first len characters of str without interning them.
+ES_API u32_t es_intern_find_len(const es_intern_t *intern, const char *str, usize_t len);
+// Get the canonical string of an id. Lives as long as the interner.
+ES_API const char *es_intern_str(const es_intern_t *intern, u32_t id);
+// Get the amount of interned strings.
+ES_API usize_t es_intern_count(const es_intern_t *intern);
+
 /*=========================*/
 // Filesystem
 /*=========================*/
@@ -753,9 +2129,14 @@ ES_INLINE b8_t matw_equal(mat4_t a, mat4_t b) { return vec4_equal(a.i, b.i) && v
 /*=========================*/
 
 typedef struct _es_profile_entry_t {
-    es_da(struct _es_profile_entry_t) children;
+    es_chunked_da(struct _es_profile_entry_t) children;
     struct _es_profile_entry_t *parent;
     const char *name;
+    // Interned name, making lookups an integer compare.
+    u32_t name_id;
+    // Name pointer the profile was last entered with, skipping interning
+    // when a block passes the same one again.
+    const char *site_name;
     f64_t t0;
     f64_t time;
     u32_t runs; 
@@ -763,6 +2144,7 @@ typedef struct _es_profile_entry_t {
 
 ES_GLOBAL _es_profile_t _es_root_profile;
 ES_GLOBAL _es_profile_t *_es_curr_profile;
+ES_GLOBAL es_intern_t _es_profile_names;
 
 ES_API _es_profile_t _es_profile_new(const char *name);
 ES_API void _es_profile_begin(const char *name);
@@ -1023,7 +2405,10 @@ ES_API void es_unit_test_free(es_unit_test_t *test);
 
 typedef es_str_t (*es_format_expander_t)(es_da(es_str_t), va_list);
 typedef struct _es_formatter_t {
-    es_hash_table(const char *, es_format_expander_t) formats;
+    // Interned format names.
+    es_intern_t names;
+    // Expander of every format name, indexed by its id.
+    es_da(es_format_expander_t) expanders;
     b8_t initialized;
 } _es_formatter_t;
 
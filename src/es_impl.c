@@ -1,19 +1,405 @@
 #include "es_header.h"
 
+#include <locale.h>
+
+/*=========================*/
+// Memory debugging
+/*=========================*/
+
+// Header placed before every tracked allocation, padded to keep alignment.
+typedef struct _es_memory_header_t {
+    usize_t size;
+    u32_t site;
+    u32_t magic;
+} _es_memory_header_t;
+
+#define _ES_MEMORY_HEADER_SIZE 16
+#define _ES_MEMORY_MAGIC 0xe5a110c5
+
+static _es_memory_site_t _es_memory_sites_g[ES_MEMORY_DEBUG_SITES];
+static es_memory_stats_t _es_memory_stats_g;
+static volatile i32_t _es_memory_lock_g;
+
+static void _es_memory_lock(void) {
+    while (__sync_lock_test_and_set(&_es_memory_lock_g, 1)) {
+        while (_es_memory_lock_g);
+    }
+}
+
+static void _es_memory_unlock(void) {
+    __sync_lock_release(&_es_memory_lock_g);
+}
+
+// Find or register an allocation site. Table must be locked.
+// Site 0 is reserved for allocations that don't fit in the table.
+static u32_t _es_memory_site(const char *file, u32_t line, const char *func) {
+    usize_t index = (((usize_t) file >> 4) ^ (line * 2654435761u)) % (ES_MEMORY_DEBUG_SITES - 1) + 1;
+    for (usize_t i = 0; i < ES_MEMORY_DEBUG_SITES - 1; i++) {
+        _es_memory_site_t *site = &_es_memory_sites_g[index];
+        if (site->file == NULL) {
+            site->file = file;
+            site->line = line;
+            site->func = func;
+            return index;
+        }
+        if (site->file == file && site->line == line) {
+            return index;
+        }
+        index = index % (ES_MEMORY_DEBUG_SITES - 1) + 1;
+    }
+
+    _es_memory_sites_g[0].file = "<overflow>";
+    _es_memory_sites_g[0].func = "";
+    return 0;
+}
+
+// Record a new allocation. Table must be locked.
+static void _es_memory_track(_es_memory_header_t *header, usize_t size, const char *file, u32_t line, const char *func) {
+    header->size = size;
+    header->site = _es_memory_site(file, line, func);
+    header->magic = _ES_MEMORY_MAGIC;
+
+    _es_memory_site_t *site = &_es_memory_sites_g[header->site];
+    site->live_bytes += size;
+    site->live_count++;
+    site->total_bytes += size;
+    site->total_count++;
+
+    usize_t bucket = 0;
+    while (bucket < ES_MEMORY_DEBUG_BUCKETS - 1 && ((usize_t) 16 << bucket) < size) {
+        bucket++;
+    }
+    site->histogram[bucket]++;
+
+    _es_memory_stats_g.live_bytes += size;
+    _es_memory_stats_g.live_count++;
+    _es_memory_stats_g.total_count++;
+    if (_es_memory_stats_g.live_bytes > _es_memory_stats_g.peak_bytes) {
+        _es_memory_stats_g.peak_bytes = _es_memory_stats_g.live_bytes;
+    }
+}
+
+// Remove an allocation from its site. Table must be locked.
+static void _es_memory_untrack(_es_memory_header_t *header) {
+    es_assert(header->magic == _ES_MEMORY_MAGIC, "Pointer wasn't allocated by the memory tracker or has already been freed.", NULL);
+    header->magic = 0;
+
+    _es_memory_site_t *site = &_es_memory_sites_g[header->site];
+    site->live_bytes -= header->size;
+    site->live_count--;
+
+    _es_memory_stats_g.live_bytes -= header->size;
+    _es_memory_stats_g.live_count--;
+}
+
+// Make an untracked allocation alive again without counting it as a new one. Table must be locked.
+static void _es_memory_retrack(_es_memory_header_t *header) {
+    header->magic = _ES_MEMORY_MAGIC;
+
+    _es_memory_site_t *site = &_es_memory_sites_g[header->site];
+    site->live_bytes += header->size;
+    site->live_count++;
+
+    _es_memory_stats_g.live_bytes += header->size;
+    _es_memory_stats_g.live_count++;
+}
+
+void *_es_memory_malloc(usize_t size, const char *file, u32_t line, const char *func) {
+    if (size > (usize_t) -1 - _ES_MEMORY_HEADER_SIZE) {
+        return NULL;
+    }
+    _es_memory_header_t *header = malloc(_ES_MEMORY_HEADER_SIZE + size);
+    if (header == NULL) {
+        return NULL;
+    }
+
+    _es_memory_lock();
+    _es_memory_track(header, size, file, line, func);
+    _es_memory_unlock();
+
+    return (u8_t *) header + _ES_MEMORY_HEADER_SIZE;
+}
+
+void *_es_memory_calloc(usize_t count, usize_t size, const char *file, u32_t line, const char *func) {
+    if (size != 0 && count > (usize_t) -1 / size) {
+        return NULL;
+    }
+    void *ptr = _es_memory_malloc(count * size, file, line, func);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+void *_es_memory_realloc(void *ptr, usize_t size, const char *file, u32_t line, const char *func) {
+    if (ptr == NULL) {
+        return _es_memory_malloc(size, file, line, func);
+    }
+
+    if (size > (usize_t) -1 - _ES_MEMORY_HEADER_SIZE) {
+        return NULL;
+    }
+
+    _es_memory_header_t *header = (_es_memory_header_t *) ((u8_t *) ptr - _ES_MEMORY_HEADER_SIZE);
+    _es_memory_lock();
+    _es_memory_untrack(header);
+    _es_memory_unlock();
+
+    _es_memory_header_t *new_header = realloc(header, _ES_MEMORY_HEADER_SIZE + size);
+    // Original allocation is still alive on failure.
+    if (new_header == NULL) {
+        _es_memory_lock();
+        _es_memory_retrack(header);
+        _es_memory_unlock();
+        return NULL;
+    }
+
+    _es_memory_lock();
+    _es_memory_track(new_header, size, file, line, func);
+    _es_memory_unlock();
+
+    return (u8_t *) new_header + _ES_MEMORY_HEADER_SIZE;
+}
+
+void _es_memory_free(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    _es_memory_header_t *header = (_es_memory_header_t *) ((u8_t *) ptr - _ES_MEMORY_HEADER_SIZE);
+    _es_memory_lock();
+    _es_memory_untrack(header);
+    _es_memory_unlock();
+
+    free(header);
+}
+
+es_memory_stats_t es_memory_stats(void) {
+    _es_memory_lock();
+    es_memory_stats_t stats = _es_memory_stats_g;
+    _es_memory_unlock();
+    return stats;
+}
+
+void es_memory_report(void) {
+    _es_memory_lock();
+
+    // Order sites by live bytes, then by total bytes.
+    u32_t order[ES_MEMORY_DEBUG_SITES];
+    usize_t count = 0;
+    for (u32_t i = 0; i < ES_MEMORY_DEBUG_SITES; i++) {
+        if (_es_memory_sites_g[i].file == NULL) {
+            continue;
+        }
+        usize_t j = count++;
+        while (j > 0) {
+            const _es_memory_site_t *a = &_es_memory_sites_g[order[j - 1]];
+            const _es_memory_site_t *b = &_es_memory_sites_g[i];
+            if (a->live_bytes > b->live_bytes || (a->live_bytes == b->live_bytes && a->total_bytes >= b->total_bytes)) {
+                break;
+            }
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    printf("========== Memory ==========\n");
+    printf("Live: %lu bytes in %lu allocations\n", _es_memory_stats_g.live_bytes, _es_memory_stats_g.live_count);
+    printf("Peak: %lu bytes\n", _es_memory_stats_g.peak_bytes);
+    printf("Total allocations: %lu\n", _es_memory_stats_g.total_count);
+    printf("Site: live_bytes live_count total_bytes total_count\n");
+    for (usize_t i = 0; i < count; i++) {
+        const _es_memory_site_t *site = &_es_memory_sites_g[order[i]];
+        printf("%s:%u (%s): %lu %lu %lu %lu\n", site->file, site->line, site->func, site->live_bytes, site->live_count, site->total_bytes, site->total_count);
+        printf("   ");
+        for (u32_t bucket = 0; bucket < ES_MEMORY_DEBUG_BUCKETS; bucket++) {
+            if (site->histogram[bucket] == 0) {
+                continue;
+            }
+            printf(" %s%lu:%lu", bucket == ES_MEMORY_DEBUG_BUCKETS - 1 ? ">" : "<=", (usize_t) 16 << (bucket == ES_MEMORY_DEBUG_BUCKETS - 1 ? bucket - 1 : bucket), site->histogram[bucket]);
+        }
+        printf("\n");
+    }
+    printf("========== End ==========\n");
+
+    _es_memory_unlock();
+}
+
+/*=========================*/
+// Arena
+/*=========================*/
+
+es_arena_t es_arena_init(usize_t chunk_size) {
+    es_arena_t arena = {0};
+    arena.chunk_size = chunk_size;
+    return arena;
+}
+
+void es_arena_free(es_arena_t *arena) {
+    es_assert(arena != NULL, "Can't free a NULL arena.", NULL);
+
+    _es_arena_chunk_t *chunk = arena->chunk;
+    while (chunk != NULL) {
+        _es_arena_chunk_t *prev = chunk->prev;
+        es_free(chunk);
+        chunk = prev;
+    }
+    arena->chunk = NULL;
+}
+
+void *es_arena_alloc(es_arena_t *arena, usize_t size) {
+    es_assert(arena != NULL, "Can't allocate from a NULL arena.", NULL);
+
+    size = _es_arena_align(size);
+
+    _es_arena_chunk_t *chunk = arena->chunk;
+    // Chain a new chunk when the current one can't fit the allocation.
+    if (chunk == NULL || chunk->used + size > chunk->cap) {
+        usize_t cap = arena->chunk_size != 0 ? arena->chunk_size : ES_ARENA_CHUNK_SIZE;
+        cap = es_max(_es_arena_align(cap), size);
+
+        _es_arena_chunk_t *new_chunk = es_malloc(_es_arena_align(sizeof(_es_arena_chunk_t)) + cap);
+        if (new_chunk == NULL) {
+            return NULL;
+        }
+        new_chunk->prev = chunk;
+        new_chunk->cap = cap;
+        new_chunk->used = 0;
+
+        arena->chunk = new_chunk;
+        chunk = new_chunk;
+    }
+
+    void *ptr = _es_arena_chunk_ptr(chunk) + chunk->used;
+    chunk->used += size;
+
+    return ptr;
+}
+
+void *es_arena_realloc(es_arena_t *arena, void *ptr, usize_t old_size, usize_t new_size) {
+    es_assert(arena != NULL, "Can't reallocate from a NULL arena.", NULL);
+
+    if (ptr == NULL) {
+        return es_arena_alloc(arena, new_size);
+    }
+
+    // Latest allocation can be resized in place.
+    _es_arena_chunk_t *chunk = arena->chunk;
+    u8_t *chunk_ptr = _es_arena_chunk_ptr(chunk);
+    usize_t offset = (u8_t *) ptr - chunk_ptr;
+    if ((u8_t *) ptr >= chunk_ptr &&
+        offset + _es_arena_align(old_size) == chunk->used &&
+        offset + _es_arena_align(new_size) <= chunk->cap) {
+        chunk->used = offset + _es_arena_align(new_size);
+        return ptr;
+    }
+
+    void *new_ptr = es_arena_alloc(arena, new_size);
+    if (new_ptr == NULL) {
+        return NULL;
+    }
+    memcpy(new_ptr, ptr, es_min(old_size, new_size));
+
+    return new_ptr;
+}
+
+es_arena_mark_t es_arena_mark(const es_arena_t *arena) {
+    es_arena_mark_t mark = {0};
+    mark.chunk = arena->chunk;
+    if (arena->chunk != NULL) {
+        mark.used = arena->chunk->used;
+    }
+    return mark;
+}
+
+void es_arena_rewind(es_arena_t *arena, es_arena_mark_t mark) {
+    es_assert(arena != NULL, "Can't rewind a NULL arena.", NULL);
+
+    // Free chunks chained after mark.
+    while (arena->chunk != mark.chunk) {
+        es_assert(arena->chunk != NULL, "Mark doesn't belong to arena.", NULL);
+        _es_arena_chunk_t *prev = arena->chunk->prev;
+        es_free(arena->chunk);
+        arena->chunk = prev;
+    }
+
+    if (arena->chunk != NULL) {
+        arena->chunk->used = mark.used;
+    }
+}
+
+void es_arena_reset(es_arena_t *arena) {
+    es_assert(arena != NULL, "Can't reset a NULL arena.", NULL);
+
+    if (arena->chunk == NULL) {
+        return;
+    }
+
+    // Single chunk only needs to be emptied.
+    if (arena->chunk->prev == NULL) {
+        arena->chunk->used = 0;
+        return;
+    }
+
+    // Coalesce multiple chunks into one so the next cycle fits without chaining.
+    usize_t cap = 0;
+    for (_es_arena_chunk_t *chunk = arena->chunk; chunk != NULL; chunk = chunk->prev) {
+        cap += chunk->cap;
+    }
+    es_arena_free(arena);
+
+    _es_arena_chunk_t *chunk = es_malloc(_es_arena_align(sizeof(_es_arena_chunk_t)) + cap);
+    if (chunk == NULL) {
+        return;
+    }
+    chunk->prev = NULL;
+    chunk->cap = cap;
+    chunk->used = 0;
+    arena->chunk = chunk;
+}
+
+const es_allocator_t *es_arena_allocator(es_arena_t *arena) {
+    es_assert(arena != NULL, "Can't get allocator of a NULL arena.", NULL);
+
+    arena->allocator.alloc = _es_arena_allocator_alloc;
+    arena->allocator.realloc = _es_arena_allocator_realloc;
+    arena->allocator.free = _es_arena_allocator_free;
+    arena->allocator.user = arena;
+
+    return &arena->allocator;
+}
+
+void *_es_arena_allocator_alloc(usize_t size, void *user) {
+    return es_arena_alloc(user, size);
+}
+
+void *_es_arena_allocator_realloc(void *ptr, usize_t old_size, usize_t new_size, void *user) {
+    return es_arena_realloc(user, ptr, old_size, new_size);
+}
+
+// Arena memory is released with the arena.
+void _es_arena_allocator_free(void *ptr, usize_t size, void *user) {
+    (void) ptr;
+    (void) size;
+    (void) user;
+}
+
 /*=========================*/
 // Dynamic array
 /*=========================*/
 
-void _es_da_init(void **arr, usize_t size) {
+void _es_da_init(void **arr, usize_t size, const es_allocator_t *allocator) {
     if (*arr != NULL || size == 0) {
         return;
     }
 
-    _es_da_header_t *head = es_malloc(sizeof(_es_da_header_t) + size * _ES_DA_INIT_CAP);
+    _es_da_header_t *head = _es_alloc(allocator, sizeof(_es_da_header_t) + size * _ES_DA_INIT_CAP);
 
     head->cap = _ES_DA_INIT_CAP;
     head->size = size;
     head->count = 0;
+    head->allocator = allocator;
 
     *arr = _es_da_ptr(head);
 }
@@ -34,7 +420,7 @@ void _es_da_insert_impl(void **arr, const void *data, usize_t index) {
     void *src = ptr + (index) * head->size;
     void *dest = ptr + (index + 1) * head->size;
 
-    memcpy(dest, src, (head->count - index) * head->size);
+    memmove(dest, src, (head->count - index) * head->size);
     memcpy(src, data, head->size);
     head->count++;
 }
@@ -52,10 +438,10 @@ void _es_da_remove_impl(void **arr, usize_t index, void *output) {
         memcpy(output, dest, head->size);
     }
 
-    memcpy(dest, src, (head->count - index - 1) * head->size);
+    memmove(dest, src, (head->count - index - 1) * head->size);
 
     _es_da_resize(arr, -1);
-    head->count--;
+    _es_da_head(*arr)->count--;
 }
 
 void _es_da_insert_fast_impl(void **arr, const void *data, usize_t index) {
@@ -69,7 +455,9 @@ void _es_da_insert_fast_impl(void **arr, const void *data, usize_t index) {
     void *src = ptr + (index) * head->size;
     void *dest = ptr + head->count * head->size;
 
-    memcpy(dest, src, head->size);
+    if (src != dest) {
+        memcpy(dest, src, head->size);
+    }
     memcpy(src, data, head->size);
     head->count++;
 }
@@ -78,6 +466,7 @@ void _es_da_remove_fast_impl(void **arr, usize_t index, void *output) {
     es_assert(arr != NULL, "Can't remove from a NULL array.", NULL);
 
     _es_da_header_t *head = _es_da_head(*arr);
+    es_assert(index < head->count, "Array index out of bounds.", NULL);
 
     u8_t *ptr = *arr;
     void *src = ptr + (head->count - 1) * head->size;
@@ -87,10 +476,10 @@ void _es_da_remove_fast_impl(void **arr, usize_t index, void *output) {
         memcpy(output, dest, head->size);
     }
 
-    memcpy(dest, src, head->size);
+    memmove(dest, src, head->size);
 
     _es_da_resize(arr, -1);
-    head->count--;
+    _es_da_head(*arr)->count--;
 }
 
 void _es_da_insert_arr_impl(void **arr, const void *data, usize_t count, usize_t index) {
@@ -102,10 +491,7 @@ void _es_da_insert_arr_impl(void **arr, const void *data, usize_t count, usize_t
     void *src = ptr + index * head->size;
     void *dest = ptr + (index + count) * head->size;
 
-    //  V          V
-    // -4 -3 -2 -1 0 1 2 3 4
-
-    memcpy(dest, src, (head->count - index) * head->size);
+    memmove(dest, src, (head->count - index) * head->size);
     if (data != NULL) {
         memcpy(src, data, head->size * count);
     } else {
@@ -127,10 +513,86 @@ void _es_da_remove_arr_impl(void **arr, usize_t count, usize_t index, void *outp
         memcpy(output, ptr + index * head->size, head->size * count);
     }
 
-    memcpy(dest, src, (head->count - index - count) * head->size);
+    memmove(dest, src, (head->count - index - count) * head->size);
     _es_da_resize(arr, -count);
 
-    head->count -= count;
+    _es_da_head(*arr)->count -= count;
+}
+
+void _es_da_append_n_impl(void **arr, const void *data, usize_t count) {
+    es_assert(arr != NULL, "Can't append to a NULL array.", NULL);
+    es_assert(data != NULL, "Can't append NULL data to array.", NULL);
+
+    if (count == 0) {
+        return;
+    }
+
+    _es_da_resize(arr, count);
+    _es_da_header_t *head = _es_da_head(*arr);
+    u8_t *start = (u8_t *) *arr + head->count * head->size;
+
+    // Fill by doubling the already copied region.
+    memcpy(start, data, head->size);
+    usize_t filled = 1;
+    while (filled < count) {
+        usize_t n = es_min(filled, count - filled);
+        memcpy(start + filled * head->size, start, n * head->size);
+        filled += n;
+    }
+    head->count += count;
+}
+
+void _es_da_extend_impl(void **arr, const void *other) {
+    es_assert(arr != NULL, "Can't extend a NULL array.", NULL);
+
+    usize_t count = es_da_count(other);
+    if (count == 0) {
+        return;
+    }
+
+    // Extending an array with itself has to survive the reallocation.
+    b8_t self = (other == *arr);
+    _es_da_resize(arr, count);
+    if (self) {
+        other = *arr;
+    }
+
+    _es_da_header_t *head = _es_da_head(*arr);
+    memcpy((u8_t *) *arr + head->count * head->size, other, count * head->size);
+    head->count += count;
+}
+
+void _es_da_splice_impl(void **arr, usize_t index, usize_t remove_count, const void *data, usize_t insert_count) {
+    es_assert(arr != NULL, "Can't splice a NULL array.", NULL);
+    es_assert(index + remove_count <= es_da_count(*arr), "Splice range out of bounds.", NULL);
+
+    // Grow before moving, shrink after.
+    if (insert_count > remove_count) {
+        _es_da_resize(arr, insert_count - remove_count);
+    }
+
+    _es_da_header_t *head = _es_da_head(*arr);
+    u8_t *ptr = *arr;
+    usize_t tail = head->count - index - remove_count;
+    memmove(ptr + (index + insert_count) * head->size, ptr + (index + remove_count) * head->size, tail * head->size);
+    if (data != NULL) {
+        memcpy(ptr + index * head->size, data, insert_count * head->size);
+    } else {
+        memset(ptr + index * head->size, 0, insert_count * head->size);
+    }
+
+    if (insert_count < remove_count) {
+        _es_da_resize(arr, -(isize_t) (remove_count - insert_count));
+        head = _es_da_head(*arr);
+    }
+    head->count = head->count - remove_count + insert_count;
+}
+
+void _es_da_resize_uninit_impl(void **arr, usize_t count) {
+    es_assert(arr != NULL, "Can't resize a NULL array.", NULL);
+
+    _es_da_reserve_impl(arr, count);
+    _es_da_head(*arr)->count = count;
 }
 
 void _es_da_free_impl(void **arr) {
@@ -139,23 +601,36 @@ void _es_da_free_impl(void **arr) {
     if (*arr == NULL) {
         return;
     }
-    es_free(_es_da_head(*arr));
+    _es_da_header_t *head = _es_da_head(*arr);
+    if (head->allocator == &_es_sda_allocator_g) {
+        return;
+    }
+    _es_free(head->allocator, head, sizeof(_es_da_header_t) + head->cap * head->size);
+}
+
+void _es_da_grow(void **arr, usize_t size) {
+    _es_da_init(arr, size, NULL);
+    _es_da_resize(arr, 1);
 }
 
 void _es_da_resize(void **arr, isize_t count) {
     es_assert(arr != NULL, "Can't resize a NULL array.", NULL);
 
     _es_da_header_t *head = _es_da_head(*arr);
-    // Double the capacity when full and inserting
-    if (count > 0 && head->count + count >= head->cap) {
-        while (head->count + count >= head->cap) {
-            head->cap <<= 1;
+    usize_t new_count = head->count + count;
+    usize_t cap = head->cap;
+    // Grow geometrically when inserting past the capacity
+    if (count > 0 && new_count > cap) {
+        while (new_count > cap) {
+            cap = es_max(cap + 1, (usize_t) (cap * ES_DA_GROWTH_FACTOR));
         }
     }
-    // Half capacity when half empty and removing
-    else if (count < 0 && head->count + count <= (head->cap >> 1)) {
-        while (head->count + count > (head->cap >> 1) && head->cap > _ES_DA_INIT_CAP) {
-            head->cap >>= 1;
+    // Half capacity when mostly empty and removing. Waiting until the
+    // array is well below half full keeps push/pop around a boundary from
+    // reallocating every time.
+    else if (count < 0 && new_count <= cap / ES_DA_SHRINK_THRESHOLD && cap > _ES_DA_INIT_CAP) {
+        while (new_count <= cap / ES_DA_SHRINK_THRESHOLD && cap > _ES_DA_INIT_CAP) {
+            cap >>= 1;
         }
     }
     // If a resize isn't needed don't do anything
@@ -163,16 +638,63 @@ void _es_da_resize(void **arr, isize_t count) {
         return;
     }
 
-    _es_da_header_t *new_head = es_realloc(head, sizeof(_es_da_header_t) + head->cap * head->size);
+    _es_da_set_cap(arr, cap);
+}
+
+void _es_da_set_cap(void **arr, usize_t cap) {
+    es_assert(arr != NULL, "Can't resize a NULL array.", NULL);
+
+    _es_da_header_t *head = _es_da_head(*arr);
+    usize_t old_size = sizeof(_es_da_header_t) + head->cap * head->size;
+    usize_t new_size = sizeof(_es_da_header_t) + cap * head->size;
+
+    // Inline storage never shrinks and spills to the heap when outgrown.
+    if (head->allocator == &_es_sda_allocator_g) {
+        if (cap <= head->cap) {
+            return;
+        }
+        // Staying inline would leave callers writing past the inline buffer.
+        _es_da_header_t *new_head = es_malloc(new_size);
+        es_assert(new_head != NULL, "Failed to move small dynamic array to the heap.", NULL);
+        memcpy(new_head, head, sizeof(_es_da_header_t) + head->count * head->size);
+        new_head->allocator = NULL;
+        new_head->cap = cap;
+        *arr = _es_da_ptr(new_head);
+        return;
+    }
+
+    _es_da_header_t *new_head = _es_realloc(head->allocator, head, old_size, new_size);
     if (new_head == NULL) {
-        es_free(head);
+        _es_free(head->allocator, head, old_size);
         *arr = NULL;
         return;
     }
+    new_head->cap = cap;
 
     *arr = _es_da_ptr(new_head);
 }
 
+void _es_da_reserve_impl(void **arr, usize_t cap) {
+    es_assert(arr != NULL, "Can't reserve a NULL array.", NULL);
+
+    if (cap > _es_da_head(*arr)->cap) {
+        _es_da_set_cap(arr, cap);
+    }
+}
+
+const es_allocator_t _es_sda_allocator_g = {0};
+
+void *_es_sda_init_impl(_es_da_header_t *head, usize_t size, usize_t cap, usize_t data_offset) {
+    es_assert(data_offset == sizeof(_es_da_header_t), "Small dynamic array entry alignment isn't supported.", NULL);
+
+    head->count = 0;
+    head->cap = cap;
+    head->size = size;
+    head->allocator = &_es_sda_allocator_g;
+
+    return _es_da_ptr(head);
+}
+
 usize_t es_da_count(const void *arr) {
     if (arr == NULL) {
         return 0;
@@ -180,48 +702,605 @@ usize_t es_da_count(const void *arr) {
     return _es_da_head(arr)->count;
 }
 
-/*=========================*/
-// Assert
-/*=========================*/
-
-void _es_assert_impl(const char *file, u32_t line, const char *expr_str, b8_t expr, const char *fmt, ...) {
-    if (expr) {
-        return;
+usize_t es_da_cap(const void *arr) {
+    if (arr == NULL) {
+        return 0;
     }
+    return _es_da_head(arr)->cap;
+}
 
-    printf("%s:%u: Assertion (%s) failed", file, line, expr_str);
-    
-    if (fmt) {
-        printf(": '");
-        va_list ptr;
-        va_start(ptr, fmt);
-        vprintf(fmt, ptr);
-        va_end(ptr);
-        printf("'");
+// Ranges this small are insertion sorted.
+#define _ES_SORT_INSERTION_THRESHOLD 16
+
+static void _es_sort_swap(u8_t *a, u8_t *b, usize_t size) {
+    u8_t temp[64];
+    while (size > 0) {
+        usize_t n = es_min(size, sizeof(temp));
+        memcpy(temp, a, n);
+        memcpy(a, b, n);
+        memcpy(b, temp, n);
+        a += n;
+        b += n;
+        size -= n;
     }
+}
 
-    printf("\n");
-    abort();
+// Stable for equal entries since they're never swapped.
+static void _es_insertion_sort(u8_t *base, usize_t count, usize_t size, es_cmp_func_t cmp) {
+    for (usize_t i = 1; i < count; i++) {
+        for (usize_t j = i; j > 0 && cmp(base + (j - 1) * size, base + j * size) > 0; j--) {
+            _es_sort_swap(base + (j - 1) * size, base + j * size, size);
+        }
+    }
 }
 
-/*=========================*/
-// Utils
-/*=========================*/
+static void _es_heap_sift_down(u8_t *base, usize_t root, usize_t count, usize_t size, es_cmp_func_t cmp) {
+    for (;;) {
+        usize_t child = root * 2 + 1;
+        if (child >= count) {
+            return;
+        }
+        if (child + 1 < count && cmp(base + child * size, base + (child + 1) * size) < 0) {
+            child++;
+        }
+        if (cmp(base + root * size, base + child * size) >= 0) {
+            return;
+        }
+        _es_sort_swap(base + root * size, base + child * size, size);
+        root = child;
+    }
+}
 
-// I just stole this.
-usize_t es_hash_str(const char *str) {
-    es_assert(sizeof(usize_t) == 8 || sizeof(usize_t) == 4, "Unsupported architecture.", NULL);
+static void _es_heap_sort(u8_t *base, usize_t count, usize_t size, es_cmp_func_t cmp) {
+    for (usize_t i = count / 2; i-- > 0;) {
+        _es_heap_sift_down(base, i, count, size, cmp);
+    }
+    for (usize_t end = count; end-- > 1;) {
+        _es_sort_swap(base, base + end * size, size);
+        _es_heap_sift_down(base, 0, end, size, cmp);
+    }
+}
 
-    // 64-bit system
-    if (sizeof(usize_t) == 8) {
-        // Magic number
-        usize_t hash = 5381;
-        i32_t c;
-        while ((c = *str++)) {
-            hash = ((hash << 5) + hash) + c;
+// Quicksort falling back to heapsort when the recursion gets too deep.
+static void _es_intro_sort(u8_t *base, usize_t count, usize_t size, es_cmp_func_t cmp, u32_t depth) {
+    while (count > _ES_SORT_INSERTION_THRESHOLD) {
+        if (depth == 0) {
+            _es_heap_sort(base, count, size, cmp);
+            return;
         }
-        return hash;
-    }
+        depth--;
+
+        // Median of three becomes the pivot at the start of the range.
+        u8_t *lo = base;
+        u8_t *mid = base + count / 2 * size;
+        u8_t *hi = base + (count - 1) * size;
+        if (cmp(mid, lo) < 0) {
+            _es_sort_swap(mid, lo, size);
+        }
+        if (cmp(hi, mid) < 0) {
+            _es_sort_swap(hi, mid, size);
+            if (cmp(mid, lo) < 0) {
+                _es_sort_swap(mid, lo, size);
+            }
+        }
+        _es_sort_swap(lo, mid, size);
+
+        usize_t i = 0, j = count;
+        for (;;) {
+            do { i++; } while (i < count && cmp(base + i * size, base) < 0);
+            do { j--; } while (cmp(base + j * size, base) > 0);
+            if (i >= j) {
+                break;
+            }
+            _es_sort_swap(base + i * size, base + j * size, size);
+        }
+        _es_sort_swap(base, base + j * size, size);
+
+        // Recurse into the smaller side to keep the stack shallow.
+        usize_t left = j, right = count - j - 1;
+        if (left < right) {
+            _es_intro_sort(base, left, size, cmp, depth);
+            base += (j + 1) * size;
+            count = right;
+        } else {
+            _es_intro_sort(base + (j + 1) * size, right, size, cmp, depth);
+            count = left;
+        }
+    }
+    _es_insertion_sort(base, count, size, cmp);
+}
+
+// Merge two neighbouring sorted runs from src into dst, taking from the left run on ties.
+static void _es_merge(const u8_t *src, u8_t *dst, usize_t left, usize_t count, usize_t size, es_cmp_func_t cmp) {
+    const u8_t *a = src, *a_end = src + left * size;
+    const u8_t *b = a_end, *b_end = src + count * size;
+    while (a < a_end && b < b_end) {
+        if (cmp(b, a) < 0) {
+            memcpy(dst, b, size);
+            b += size;
+        } else {
+            memcpy(dst, a, size);
+            a += size;
+        }
+        dst += size;
+    }
+    memcpy(dst, a, a_end - a);
+    memcpy(dst + (a_end - a), b, b_end - b);
+}
+
+// Bottom up merge sort using temp as scratch space. The result ends up in base.
+static void _es_merge_sort(u8_t *base, u8_t *temp, usize_t count, usize_t size, es_cmp_func_t cmp) {
+    for (usize_t i = 0; i < count; i += _ES_SORT_INSERTION_THRESHOLD) {
+        _es_insertion_sort(base + i * size, es_min(_ES_SORT_INSERTION_THRESHOLD, count - i), size, cmp);
+    }
+
+    u8_t *src = base, *dst = temp;
+    for (usize_t width = _ES_SORT_INSERTION_THRESHOLD; width < count; width *= 2) {
+        for (usize_t i = 0; i < count; i += width * 2) {
+            usize_t run = es_min(width * 2, count - i);
+            _es_merge(src + i * size, dst + i * size, es_min(width, run), run, size, cmp);
+        }
+        u8_t *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != base) {
+        memcpy(base, src, count * size);
+    }
+}
+
+static u32_t _es_sort_depth(usize_t count) {
+    u32_t depth = 0;
+    while (count > 1) {
+        count >>= 1;
+        depth += 2;
+    }
+    return depth;
+}
+
+static void _es_sort_range(u8_t *base, u8_t *temp, usize_t count, usize_t size, es_cmp_func_t cmp, b8_t stable) {
+    if (stable) {
+        _es_merge_sort(base, temp, count, size, cmp);
+    } else {
+        _es_intro_sort(base, count, size, cmp, _es_sort_depth(count));
+    }
+}
+
+typedef struct _es_sort_task_t {
+    u8_t *src;
+    u8_t *dst;
+    usize_t left;
+    usize_t count;
+    usize_t size;
+    es_cmp_func_t cmp;
+    b8_t stable;
+} _es_sort_task_t;
+
+static void _es_sort_task_sort(void *arg) {
+    _es_sort_task_t *task = arg;
+    _es_sort_range(task->src, task->dst, task->count, task->size, task->cmp, task->stable);
+}
+
+static void _es_sort_task_merge(void *arg) {
+    _es_sort_task_t *task = arg;
+    _es_merge(task->src, task->dst, task->left, task->count, task->size, task->cmp);
+}
+
+// Run every task, the last one on the calling thread.
+static void _es_sort_run_tasks(_es_sort_task_t *tasks, usize_t count, es_thread_proc_t proc) {
+    es_thread_t threads[ES_DA_SORT_THREADS];
+    for (usize_t i = 0; i + 1 < count; i++) {
+        threads[i] = es_thread(proc, &tasks[i]);
+    }
+    proc(&tasks[count - 1]);
+    for (usize_t i = 0; i + 1 < count; i++) {
+        es_thread_wait(threads[i]);
+    }
+}
+
+// Sort one chunk per thread then merge neighbouring chunks in parallel until one run is left.
+static void _es_parallel_sort(u8_t *base, u8_t *temp, usize_t count, usize_t size, es_cmp_func_t cmp, b8_t stable) {
+    _es_sort_task_t tasks[ES_DA_SORT_THREADS];
+    usize_t chunk = (count + ES_DA_SORT_THREADS - 1) / ES_DA_SORT_THREADS;
+
+    usize_t task_count = 0;
+    for (usize_t i = 0; i < count; i += chunk) {
+        tasks[task_count++] = (_es_sort_task_t) {
+            base + i * size, temp + i * size, 0, es_min(chunk, count - i), size, cmp, stable
+        };
+    }
+    _es_sort_run_tasks(tasks, task_count, _es_sort_task_sort);
+
+    u8_t *src = base, *dst = temp;
+    for (usize_t width = chunk; width < count; width *= 2) {
+        task_count = 0;
+        for (usize_t i = 0; i < count; i += width * 2) {
+            usize_t run = es_min(width * 2, count - i);
+            tasks[task_count++] = (_es_sort_task_t) {
+                src + i * size, dst + i * size, es_min(width, run), run, size, cmp, stable
+            };
+        }
+        _es_sort_run_tasks(tasks, task_count, _es_sort_task_merge);
+        u8_t *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != base) {
+        memcpy(base, src, count * size);
+    }
+}
+
+void _es_da_sort_impl(void *arr, es_cmp_func_t cmp, b8_t stable) {
+    usize_t count = es_da_count(arr);
+    if (count < 2) {
+        return;
+    }
+    usize_t size = _es_da_head(arr)->size;
+
+    b8_t parallel = ES_DA_SORT_THREADS > 1 && count >= ES_DA_SORT_PARALLEL_THRESHOLD;
+    if (!stable && !parallel) {
+        _es_intro_sort(arr, count, size, cmp, _es_sort_depth(count));
+        return;
+    }
+
+    u8_t *temp = es_malloc(count * size);
+    es_assert(temp != NULL, "Failed to allocate sort scratch space.", NULL);
+    if (parallel) {
+        _es_parallel_sort(arr, temp, count, size, cmp, stable);
+    } else {
+        _es_merge_sort(arr, temp, count, size, cmp);
+    }
+    es_free(temp);
+}
+
+usize_t _es_da_lower_bound_impl(const void *arr, const void *key, es_cmp_func_t cmp) {
+    usize_t count = es_da_count(arr);
+    if (count == 0) {
+        return 0;
+    }
+    usize_t size = _es_da_head(arr)->size;
+
+    const u8_t *base = arr;
+    usize_t first = 0;
+    while (count > 0) {
+        usize_t half = count / 2;
+        if (cmp(base + (first + half) * size, key) < 0) {
+            first += half + 1;
+            count -= half + 1;
+        } else {
+            count = half;
+        }
+    }
+
+    return first;
+}
+
+void *_es_da_bsearch_impl(const void *arr, const void *key, es_cmp_func_t cmp) {
+    usize_t index = _es_da_lower_bound_impl(arr, key, cmp);
+    if (index >= es_da_count(arr)) {
+        return NULL;
+    }
+
+    u8_t *entry = (u8_t *) arr + index * _es_da_head(arr)->size;
+    if (cmp(entry, key) != 0) {
+        return NULL;
+    }
+    return entry;
+}
+
+/*=========================*/
+// Chunked dynamic array
+/*=========================*/
+
+void _es_chunked_da_init(es_chunked_da_t *cda, usize_t size, const es_allocator_t *allocator) {
+    es_assert(cda->count == 0 && cda->blocks == NULL, "Can't initialize a chunked dynamic array holding entries.", NULL);
+
+    // Largest power of two amount of entries fitting in a block, at least one.
+    usize_t shift = 0;
+    while (((usize_t) 2 << shift) * size <= ES_CHUNKED_DA_BLOCK_SIZE) {
+        shift++;
+    }
+
+    cda->size = size;
+    cda->block_shift = shift;
+    cda->allocator = allocator;
+}
+
+void _es_chunked_da_free_impl(es_chunked_da_t *cda) {
+    usize_t block_size = cda->size << cda->block_shift;
+    for (usize_t i = 0; i < es_da_count(cda->blocks); i++) {
+        _es_free(cda->allocator, cda->blocks[i], block_size);
+    }
+    es_da_free(cda->blocks);
+    cda->blocks = NULL;
+    cda->count = 0;
+}
+
+void *_es_chunked_da_push_impl(es_chunked_da_t *cda, usize_t size) {
+    if (cda->size == 0) {
+        _es_chunked_da_init(cda, size, cda->allocator);
+    }
+
+    usize_t block = cda->count >> cda->block_shift;
+    if (block == es_da_count(cda->blocks)) {
+        if (cda->blocks == NULL) {
+            es_da_init_allocator(cda->blocks, cda->allocator);
+        }
+        es_da_push(cda->blocks, _es_alloc(cda->allocator, cda->size << cda->block_shift));
+    }
+
+    usize_t index = cda->count & (((usize_t) 1 << cda->block_shift) - 1);
+    cda->count++;
+
+    return cda->blocks[block] + index * cda->size;
+}
+
+void _es_chunked_da_pop_impl(es_chunked_da_t *cda, void *out) {
+    es_assert(cda->count > 0, "Can't pop from an empty chunked dynamic array.", NULL);
+
+    cda->count--;
+    if (out != NULL) {
+        usize_t block = cda->count >> cda->block_shift;
+        usize_t index = cda->count & (((usize_t) 1 << cda->block_shift) - 1);
+        memcpy(out, cda->blocks[block] + index * cda->size, cda->size);
+    }
+}
+
+void _es_chunked_da_shrink_to_fit_impl(es_chunked_da_t *cda) {
+    usize_t used = _es_chunked_da_block_count_impl(cda);
+    usize_t block_size = cda->size << cda->block_shift;
+    while (es_da_count(cda->blocks) > used) {
+        u8_t *block;
+        es_da_pop(cda->blocks, &block);
+        _es_free(cda->allocator, block, block_size);
+    }
+}
+
+usize_t _es_chunked_da_block_count_impl(const es_chunked_da_t *cda) {
+    return (cda->count + ((usize_t) 1 << cda->block_shift) - 1) >> cda->block_shift;
+}
+
+usize_t _es_chunked_da_block_len_impl(const es_chunked_da_t *cda, usize_t block) {
+    usize_t first = block << cda->block_shift;
+    if (first >= cda->count) {
+        return 0;
+    }
+    return es_min(cda->count - first, (usize_t) 1 << cda->block_shift);
+}
+
+/*=========================*/
+// Ring buffer
+/*=========================*/
+
+void _es_ring_init(es_ring_t *ring, usize_t size, const es_allocator_t *allocator) {
+    es_assert(ring->data == NULL, "Can't initialize a ring buffer holding memory.", NULL);
+
+    ring->size = size;
+    ring->allocator = allocator;
+}
+
+void _es_ring_free_impl(es_ring_t *ring) {
+    if (ring->data != NULL) {
+        _es_free(ring->allocator, ring->data, ring->cap * ring->size);
+    }
+    ring->data = NULL;
+    ring->head = 0;
+    ring->count = 0;
+    ring->cap = 0;
+}
+
+void _es_ring_reserve_impl(es_ring_t *ring, usize_t size, usize_t cap) {
+    if (cap <= ring->cap) {
+        return;
+    }
+    if (ring->size == 0) {
+        ring->size = size;
+    }
+
+    usize_t old_cap = ring->cap;
+    usize_t new_cap = es_max(old_cap, (usize_t) _ES_RING_INIT_CAP);
+    while (new_cap < cap) {
+        new_cap <<= 1;
+    }
+
+    if (ring->data == NULL) {
+        ring->data = _es_alloc(ring->allocator, new_cap * ring->size);
+    } else {
+        ring->data = _es_realloc(ring->allocator, ring->data, old_cap * ring->size, new_cap * ring->size);
+    }
+    es_assert(ring->data != NULL, "Failed to grow ring buffer.", NULL);
+
+    // Entries wrapping past the old end are moved to directly follow the old
+    // end. Capacity at least doubles so they always fit.
+    if (ring->head + ring->count > old_cap) {
+        usize_t wrapped = ring->head + ring->count - old_cap;
+        memcpy(ring->data + old_cap * ring->size, ring->data, wrapped * ring->size);
+    }
+    ring->cap = new_cap;
+}
+
+void _es_ring_push_back_arr_impl(es_ring_t *ring, const void *data, usize_t count) {
+    es_assert(ring->count + count <= ring->cap, "Ring buffer must be reserved before pushing an array.", NULL);
+
+    const u8_t *src = data;
+    usize_t tail = (ring->head + ring->count) & (ring->cap - 1);
+    usize_t first = es_min(count, ring->cap - tail);
+    memcpy(ring->data + tail * ring->size, src, first * ring->size);
+    memcpy(ring->data, src + first * ring->size, (count - first) * ring->size);
+    ring->count += count;
+}
+
+void _es_ring_pop_front_arr_impl(es_ring_t *ring, usize_t count, void *out) {
+    es_assert(count <= ring->count, "Can't pop more entries than a ring buffer holds.", NULL);
+
+    if (out != NULL) {
+        u8_t *dst = out;
+        usize_t first = es_min(count, ring->cap - ring->head);
+        memcpy(dst, ring->data + ring->head * ring->size, first * ring->size);
+        memcpy(dst + first * ring->size, ring->data, (count - first) * ring->size);
+    }
+    if (count > 0) {
+        ring->head = (ring->head + count) & (ring->cap - 1);
+        ring->count -= count;
+    }
+}
+
+void *_es_ring_span_impl(const es_ring_t *ring, usize_t index, usize_t *len) {
+    if (index >= ring->count) {
+        *len = 0;
+        return NULL;
+    }
+
+    usize_t start = (ring->head + index) & (ring->cap - 1);
+    *len = es_min(ring->count - index, ring->cap - start);
+    return ring->data + start * ring->size;
+}
+
+/*=========================*/
+// Structure of arrays
+/*=========================*/
+
+void _es_soa_init(es_soa_t *soa, const usize_t *sizes, usize_t column_count, usize_t total_size, const es_allocator_t *allocator) {
+    es_assert(column_count <= ES_SOA_MAX_COLUMNS, "Too many structure of arrays fields. Increase ES_SOA_MAX_COLUMNS.", NULL);
+    es_assert(total_size == sizeof(es_soa_t) + column_count * sizeof(void *), "Structure of arrays columns must directly follow the header.", NULL);
+
+    memset(soa, 0, total_size);
+    memcpy(soa->sizes, sizes, column_count * sizeof(usize_t));
+    soa->column_count = column_count;
+    soa->allocator = allocator;
+}
+
+// Copy the column pointers to the typed pointers following the header. Copying the
+// bytes keeps every typed pointer accessed only through its own type.
+static void _es_soa_publish(const es_soa_t *soa, void *fields) {
+    memcpy(fields, soa->columns, soa->column_count * sizeof(void *));
+}
+
+void _es_soa_free_impl(es_soa_t *soa, void *fields) {
+    for (usize_t i = 0; i < soa->column_count; i++) {
+        if (soa->columns[i] != NULL) {
+            _es_free(soa->allocator, soa->columns[i], soa->cap * soa->sizes[i]);
+        }
+        soa->columns[i] = NULL;
+    }
+    soa->count = 0;
+    soa->cap = 0;
+    _es_soa_publish(soa, fields);
+}
+
+void _es_soa_reserve_impl(es_soa_t *soa, void *fields, usize_t cap) {
+    if (cap <= soa->cap) {
+        return;
+    }
+
+    for (usize_t i = 0; i < soa->column_count; i++) {
+        if (soa->columns[i] == NULL) {
+            soa->columns[i] = _es_alloc(soa->allocator, cap * soa->sizes[i]);
+        } else {
+            soa->columns[i] = _es_realloc(soa->allocator, soa->columns[i], soa->cap * soa->sizes[i], cap * soa->sizes[i]);
+        }
+        es_assert(soa->columns[i] != NULL, "Failed to grow structure of arrays column.", NULL);
+    }
+    soa->cap = cap;
+    _es_soa_publish(soa, fields);
+}
+
+usize_t _es_soa_push_impl(es_soa_t *soa, void *fields) {
+    es_assert(soa->column_count > 0, "Structure of arrays must be initialized before use.", NULL);
+
+    if (soa->count == soa->cap) {
+        usize_t cap = es_max(soa->cap + 1, (usize_t) (soa->cap * ES_DA_GROWTH_FACTOR));
+        _es_soa_reserve_impl(soa, fields, es_max(cap, (usize_t) _ES_DA_INIT_CAP));
+    }
+
+    usize_t index = soa->count++;
+    for (usize_t i = 0; i < soa->column_count; i++) {
+        memset((u8_t *) soa->columns[i] + index * soa->sizes[i], 0, soa->sizes[i]);
+    }
+    return index;
+}
+
+void _es_soa_remove_impl(es_soa_t *soa, usize_t index) {
+    es_assert(index < soa->count, "Structure of arrays index out of bounds.", NULL);
+
+    soa->count--;
+    for (usize_t i = 0; i < soa->column_count; i++) {
+        u8_t *column = soa->columns[i];
+        usize_t size = soa->sizes[i];
+        memmove(column + index * size, column + (index + 1) * size, (soa->count - index) * size);
+    }
+}
+
+void _es_soa_remove_fast_impl(es_soa_t *soa, usize_t index) {
+    es_assert(index < soa->count, "Structure of arrays index out of bounds.", NULL);
+
+    soa->count--;
+    if (index == soa->count) {
+        return;
+    }
+    for (usize_t i = 0; i < soa->column_count; i++) {
+        u8_t *column = soa->columns[i];
+        usize_t size = soa->sizes[i];
+        memcpy(column + index * size, column + soa->count * size, size);
+    }
+}
+
+void _es_soa_swap_impl(es_soa_t *soa, usize_t a, usize_t b) {
+    es_assert(a < soa->count && b < soa->count, "Structure of arrays index out of bounds.", NULL);
+
+    if (a == b) {
+        return;
+    }
+    for (usize_t i = 0; i < soa->column_count; i++) {
+        u8_t *column = soa->columns[i];
+        _es_sort_swap(column + a * soa->sizes[i], column + b * soa->sizes[i], soa->sizes[i]);
+    }
+}
+
+/*=========================*/
+// Assert
+/*=========================*/
+
+void _es_assert_impl(const char *file, u32_t line, const char *expr_str, b8_t expr, const char *fmt, ...) {
+    if (expr) {
+        return;
+    }
+
+    printf("%s:%u: Assertion (%s) failed", file, line, expr_str);
+    
+    if (fmt) {
+        printf(": '");
+        va_list ptr;
+        va_start(ptr, fmt);
+        vprintf(fmt, ptr);
+        va_end(ptr);
+        printf("'");
+    }
+
+    printf("\n");
+    abort();
+}
+
+/*=========================*/
+// Utils
+/*=========================*/
+
+// I just stole this.
+usize_t es_hash_str(const char *str) {
+    es_assert(sizeof(usize_t) == 8 || sizeof(usize_t) == 4, "Unsupported architecture.", NULL);
+
+    // 64-bit system
+    if (sizeof(usize_t) == 8) {
+        // Magic number
+        usize_t hash = 5381;
+        i32_t c;
+        while ((c = *str++)) {
+            hash = ((hash << 5) + hash) + c;
+        }
+        return hash;
+    }
     // 32-bit system
     usize_t hash1 = 5381;
     usize_t hash2 = 5381;
@@ -290,6 +1369,141 @@ usize_t es_siphash(const void *p, usize_t len, usize_t seed) {
     #undef es_sipround
 }
 
+// wyhash final version 4 by Wang Yi, released into the public domain.
+// Reads are little endian, so hashes differ on big endian machines.
+static const u64_t _es_wyhash_secret[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull,
+};
+
+// Multiply into 128 bits, storing the low half in a and the high half in b.
+ES_INLINE void _es_wymum(u64_t *a, u64_t *b) {
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 _es_u128_t;
+    _es_u128_t r = (_es_u128_t) *a * *b;
+    *a = (u64_t) r;
+    *b = (u64_t) (r >> 64);
+#else
+    u64_t ha = *a >> 32, hb = *b >> 32, la = (u32_t) *a, lb = (u32_t) *b;
+    u64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    u64_t t = rl + (rm0 << 32), c = t < rl;
+    u64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif // __SIZEOF_INT128__
+}
+
+ES_INLINE u64_t _es_wymix(u64_t a, u64_t b) {
+    _es_wymum(&a, &b);
+    return a ^ b;
+}
+
+ES_INLINE u64_t _es_wyr8(const u8_t *p) { u64_t v; memcpy(&v, p, 8); return v; }
+ES_INLINE u64_t _es_wyr4(const u8_t *p) { u32_t v; memcpy(&v, p, 4); return v; }
+ES_INLINE u64_t _es_wyr3(const u8_t *p, usize_t k) { return ((u64_t) p[0] << 16) | ((u64_t) p[k >> 1] << 8) | p[k - 1]; }
+
+// Hash three 8 byte lanes of a 48 byte stripe in parallel.
+ES_INLINE void _es_wyhash_stripe(const u8_t *p, u64_t *seed, u64_t *see1, u64_t *see2) {
+    *seed = _es_wymix(_es_wyr8(p) ^ _es_wyhash_secret[1], _es_wyr8(p + 8) ^ *seed);
+    *see1 = _es_wymix(_es_wyr8(p + 16) ^ _es_wyhash_secret[2], _es_wyr8(p + 24) ^ *see1);
+    *see2 = _es_wymix(_es_wyr8(p + 32) ^ _es_wyhash_secret[3], _es_wyr8(p + 40) ^ *see2);
+}
+
+// Finish a hash over inputs longer than 16 bytes. The last 16 bytes before
+// p + len must be readable even when len is less than 16.
+static u64_t _es_wyhash_tail(const u8_t *p, usize_t len, u64_t total, u64_t seed) {
+    while (len > 16) {
+        seed = _es_wymix(_es_wyr8(p) ^ _es_wyhash_secret[1], _es_wyr8(p + 8) ^ seed);
+        p += 16;
+        len -= 16;
+    }
+    u64_t a = _es_wyr8(p + len - 16) ^ _es_wyhash_secret[1];
+    u64_t b = _es_wyr8(p + len - 8) ^ seed;
+    _es_wymum(&a, &b);
+    return _es_wymix(a ^ _es_wyhash_secret[0] ^ total, b ^ _es_wyhash_secret[1]);
+}
+
+static u64_t _es_wyhash_short(const u8_t *p, usize_t len, u64_t seed) {
+    u64_t a = 0, b = 0;
+    if (len >= 4) {
+        a = (_es_wyr4(p) << 32) | _es_wyr4(p + ((len >> 3) << 2));
+        b = (_es_wyr4(p + len - 4) << 32) | _es_wyr4(p + len - 4 - ((len >> 3) << 2));
+    } else if (len > 0) {
+        a = _es_wyr3(p, len);
+    }
+    a ^= _es_wyhash_secret[1];
+    b ^= seed;
+    _es_wymum(&a, &b);
+    return _es_wymix(a ^ _es_wyhash_secret[0] ^ len, b ^ _es_wyhash_secret[1]);
+}
+
+usize_t es_wyhash(const void *data, usize_t len, usize_t seed) {
+    const u8_t *p = data;
+    u64_t s = seed;
+    s ^= _es_wymix(s ^ _es_wyhash_secret[0], _es_wyhash_secret[1]);
+
+    if (len <= 16) {
+        return _es_wyhash_short(p, len, s);
+    }
+
+    usize_t i = len;
+    if (i >= 48) {
+        u64_t see1 = s, see2 = s;
+        do {
+            _es_wyhash_stripe(p, &s, &see1, &see2);
+            p += 48;
+            i -= 48;
+        } while (i >= 48);
+        s ^= see1 ^ see2;
+    }
+    return _es_wyhash_tail(p, i, len, s);
+}
+
+es_hasher_t es_hasher_init(usize_t seed) {
+    es_hasher_t hasher = {0};
+    hasher.seed = seed;
+    hasher.seed ^= _es_wymix(hasher.seed ^ _es_wyhash_secret[0], _es_wyhash_secret[1]);
+    hasher.see1 = hasher.seed;
+    hasher.see2 = hasher.seed;
+    return hasher;
+}
+
+// Stripes are hashed as soon as 48 bytes are buffered, like es_wyhash does.
+// The last 16 bytes of the latest stripe are kept for the final read.
+void es_hasher_update(es_hasher_t *hasher, const void *data, usize_t len) {
+    const u8_t *p = data;
+    hasher->len += len;
+
+    while (len > 0) {
+        usize_t n = es_min(len, sizeof(hasher->buffer) - hasher->buffered);
+        memcpy(hasher->buffer + hasher->buffered, p, n);
+        hasher->buffered += n;
+        p += n;
+        len -= n;
+
+        if (hasher->buffered == sizeof(hasher->buffer)) {
+            _es_wyhash_stripe(hasher->buffer, &hasher->seed, &hasher->see1, &hasher->see2);
+            memcpy(hasher->last, hasher->buffer + sizeof(hasher->buffer) - sizeof(hasher->last), sizeof(hasher->last));
+            hasher->buffered = 0;
+        }
+    }
+}
+
+usize_t es_hasher_final(const es_hasher_t *hasher) {
+    if (hasher->len <= 16) {
+        return _es_wyhash_short(hasher->buffer, hasher->len, hasher->seed);
+    }
+    if (hasher->len < 48) {
+        return _es_wyhash_tail(hasher->buffer, hasher->buffered, hasher->len, hasher->seed);
+    }
+
+    u8_t tail[sizeof(hasher->last) + sizeof(hasher->buffer)];
+    memcpy(tail, hasher->last, sizeof(hasher->last));
+    memcpy(tail + sizeof(hasher->last), hasher->buffer, hasher->buffered);
+    u64_t seed = hasher->seed ^ hasher->see1 ^ hasher->see2;
+    return _es_wyhash_tail(tail + sizeof(hasher->last), hasher->buffered, hasher->len, seed);
+}
+
 #ifdef ES_OS_LINUX
 f64_t es_get_time(void) {
     struct timespec t;
@@ -334,64 +1548,506 @@ void _es_win32_clock_setup(void) {
 // Hash table
 /*=========================*/
 
-// Search for wanted entry, if not found, find the first dead entry and return that.
-usize_t _es_hash_table_get_index(usize_t wanted_hash, void **entries, usize_t entry_count, usize_t entry_size, usize_t hash_offset, usize_t state_offset) {
-    u8_t *ptr = *entries;
-    usize_t index = wanted_hash % entry_count;
-    usize_t entry_hash = *(usize_t *) (ptr + hash_offset);
-    // Find wanted entry.
-    for (usize_t count = 0; count < entry_count; count++) {
-        u8_t *entry_ptr = ptr + index * entry_size;
-        entry_hash = *(usize_t *) (entry_ptr + hash_offset);
-        _es_hash_table_entry_state_t state = *(_es_hash_table_entry_state_t *) (entry_ptr + state_offset);
-        // Return if found.
-        if (entry_hash == wanted_hash && state == _ES_HASH_TABLE_ENTRY_ALIVE) {
-            return index;
-        }
-        index = (index + 1) % entry_count;
-    }
+#define _es_hash_table_entry_hash(LAYOUT, ENTRIES, I) \
+    (*(usize_t *) ((u8_t *) (ENTRIES) + (I) * (LAYOUT)->entry_size + (LAYOUT)->hash_offset))
+#define _es_hash_table_entry_key(LAYOUT, ENTRIES, I) \
+    ((const u8_t *) (ENTRIES) + (I) * (LAYOUT)->entry_size + (LAYOUT)->key_offset)
+
+// Control byte stored for an alive slot.
+#define _es_hash_table_h2(HASH) ((u8_t) ((HASH) & 0x7f))
+// Group the probe sequence starts at. Group count is a power of two.
+#define _es_hash_table_h1(HASH, GROUPS) (((HASH) >> 7) & ((GROUPS) - 1))
+// Triangular probing, which visits every group once when the group count is a power of two.
+#define _es_hash_table_next_group(GROUP, PROBE, GROUPS) (((GROUP) + (PROBE) + 1) & ((GROUPS) - 1))
+
+// Group matching produces a bitmask with one set bit per matching slot. NEON
+// has no movemask so its masks use four bits per slot, of which one is kept.
+#if defined(ES_SIMD_SSE2)
+typedef u32_t _es_hash_table_mask_t;
+#define _ES_HASH_TABLE_MASK_SHIFT 0
+
+ES_INLINE _es_hash_table_mask_t _es_hash_table_group_match(const u8_t *group, u8_t byte) {
+    __m128i ctrl = _mm_loadu_si128((const __m128i *) group);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char) byte)));
+}
+
+// Empty and tombstone bytes are the only ones with the high bit set.
+ES_INLINE _es_hash_table_mask_t _es_hash_table_group_match_free(const u8_t *group) {
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) group));
+}
+#elif defined(ES_SIMD_NEON)
+typedef u64_t _es_hash_table_mask_t;
+#define _ES_HASH_TABLE_MASK_SHIFT 2
+
+ES_INLINE _es_hash_table_mask_t _es_hash_table_neon_mask(uint8x16_t cmp) {
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ull;
+}
+
+ES_INLINE _es_hash_table_mask_t _es_hash_table_group_match(const u8_t *group, u8_t byte) {
+    return _es_hash_table_neon_mask(vceqq_u8(vld1q_u8(group), vdupq_n_u8(byte)));
+}
+
+ES_INLINE _es_hash_table_mask_t _es_hash_table_group_match_free(const u8_t *group) {
+    return _es_hash_table_neon_mask(vcltq_s8(vreinterpretq_s8_u8(vld1q_u8(group)), vdupq_n_s8(0)));
+}
+#else
+typedef u32_t _es_hash_table_mask_t;
+#define _ES_HASH_TABLE_MASK_SHIFT 0
+
+ES_INLINE _es_hash_table_mask_t _es_hash_table_group_match(const u8_t *group, u8_t byte) {
+    _es_hash_table_mask_t mask = 0;
+    for (u32_t i = 0; i < _ES_HASH_TABLE_GROUP; i++) {
+        mask |= (_es_hash_table_mask_t) (group[i] == byte) << i;
+    }
+    return mask;
+}
+
+ES_INLINE _es_hash_table_mask_t _es_hash_table_group_match_free(const u8_t *group) {
+    _es_hash_table_mask_t mask = 0;
+    for (u32_t i = 0; i < _ES_HASH_TABLE_GROUP; i++) {
+        mask |= (_es_hash_table_mask_t) (group[i] >> 7) << i;
+    }
+    return mask;
+}
+#endif
+
+ES_INLINE _es_hash_table_mask_t _es_hash_table_group_match_empty(const u8_t *group) {
+    return _es_hash_table_group_match(group, _ES_HASH_TABLE_CTRL_EMPTY);
+}
 
-    // Find first dead entry.
-    usize_t dead_index = 0;
-    for (usize_t count = 0; count < entry_count; count++) {
-        u8_t *entry_ptr = ptr + count * entry_size;
-        _es_hash_table_entry_state_t state = *(_es_hash_table_entry_state_t *) (entry_ptr + state_offset);
-        if (state == _ES_HASH_TABLE_ENTRY_DEAD) {
-            dead_index = count;
+// Slot offset of the lowest set bit in a match mask.
+#define _es_hash_table_mask_slot(MASK) ((usize_t) __builtin_ctzll(MASK) >> _ES_HASH_TABLE_MASK_SHIFT)
+
+// Get the hash of an alive entry. Entries without a stored hash have their key hashed again.
+static usize_t _es_hash_table_slot_hash(const _es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, const void *entries, usize_t index) {
+    if (layout->hash_offset == _ES_HASH_TABLE_NO_HASH) {
+        return _es_hash_table_hash_key(ht->hash_func, layout->string_key, _es_hash_table_entry_key(layout, entries, index), layout->key_size);
+    }
+    return _es_hash_table_entry_hash(layout, entries, index);
+}
+
+static b8_t _es_hash_table_key_eq(const _es_hash_table_layout_t *layout, const void *a, const void *b) {
+    if (layout->string_key) {
+        return es_cstr_cmp(*(const char **) a, *(const char **) b) == 0;
+    }
+    return memcmp(a, b, layout->key_size) == 0;
+}
+
+// Groups are probed from the hashed group. Only slots whose control
+// byte matches the hash fragment have their entry loaded. The load factor,
+// counting tombstones, guarantees an empty slot ends every probe sequence.
+static usize_t _es_hash_table_find(const _es_hash_table_layout_t *layout, const void *entries, const u8_t *ctrl, usize_t cap, usize_t hash, const void *key) {
+    usize_t groups = cap / _ES_HASH_TABLE_GROUP;
+    usize_t group = _es_hash_table_h1(hash, groups);
+    u8_t h2 = _es_hash_table_h2(hash);
+
+    for (usize_t probes = 0; probes < groups; probes++) {
+        const u8_t *group_ctrl = ctrl + group * _ES_HASH_TABLE_GROUP;
+        for (_es_hash_table_mask_t mask = _es_hash_table_group_match(group_ctrl, h2); mask != 0; mask &= mask - 1) {
+            usize_t index = group * _ES_HASH_TABLE_GROUP + _es_hash_table_mask_slot(mask);
+            if ((layout->hash_offset == _ES_HASH_TABLE_NO_HASH || _es_hash_table_entry_hash(layout, entries, index) == hash) &&
+                _es_hash_table_key_eq(layout, _es_hash_table_entry_key(layout, entries, index), key)) {
+                return index;
+            }
+        }
+        if (_es_hash_table_group_match_empty(group_ctrl) != 0) {
             break;
         }
+        group = _es_hash_table_next_group(group, probes, groups);
     }
 
-    return dead_index;
+    return cap;
 }
 
-// Hash value differently dependant on what key type the hash table uses.
-usize_t _es_hash_table_hash_key(b8_t is_string, void **ptr, usize_t len) {
-    if (is_string) {
-        return es_hash_str((const char *) *ptr);
+// Get the first empty or tombstone slot in the probe sequence.
+static usize_t _es_hash_table_find_free(const u8_t *ctrl, usize_t cap, usize_t hash) {
+    usize_t groups = cap / _ES_HASH_TABLE_GROUP;
+    usize_t group = _es_hash_table_h1(hash, groups);
+    _es_hash_table_mask_t mask;
+    for (usize_t probes = 0; (mask = _es_hash_table_group_match_free(ctrl + group * _ES_HASH_TABLE_GROUP)) == 0; probes++) {
+        group = _es_hash_table_next_group(group, probes, groups);
     }
-    return es_siphash((void *) ptr, len, ES_HASH_TABLE_SEED);
+    return group * _ES_HASH_TABLE_GROUP + _es_hash_table_mask_slot(mask);
 }
 
-usize_t _es_hash_table_iter_new_impl(void *entries, usize_t state_stride, usize_t entry_size, usize_t cap) {
-    for (usize_t i = 0; i < cap; i++) {
-        _es_hash_table_entry_state_t state = *(_es_hash_table_entry_state_t *) ((u8_t *) entries + i * entry_size + state_stride);
-        if (state == _ES_HASH_TABLE_ENTRY_ALIVE) {
-            return i;
+// Copy an entry into a free slot of the current arrays.
+static void *_es_hash_table_place(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, const void *entry, u8_t h2, usize_t hash) {
+    usize_t index = _es_hash_table_find_free(ht->ctrl, es_da_count(ht->ctrl), hash);
+    if (ht->ctrl[index] == _ES_HASH_TABLE_CTRL_TOMBSTONE) {
+        ht->tombstones--;
+    }
+    ht->ctrl[index] = h2;
+
+    u8_t *dst = (u8_t *) ht->entries + index * layout->entry_size;
+    if (entry != NULL) {
+        memcpy(dst, entry, layout->entry_size);
+    }
+    return dst;
+}
+
+// Zero an entry and free its slot. Returns true if the slot became a tombstone.
+static b8_t _es_hash_table_erase(const _es_hash_table_layout_t *layout, void *entries, u8_t *ctrl, usize_t index) {
+    memset((u8_t *) entries + index * layout->entry_size, 0, layout->entry_size);
+    // A group holding an empty slot was never full, so no probe sequence
+    // continued past it and the slot can become empty again.
+    if (_es_hash_table_group_match_empty(ctrl + index / _ES_HASH_TABLE_GROUP * _ES_HASH_TABLE_GROUP) != 0) {
+        ctrl[index] = _ES_HASH_TABLE_CTRL_EMPTY;
+        return false;
+    }
+    ctrl[index] = _ES_HASH_TABLE_CTRL_TOMBSTONE;
+    return true;
+}
+
+static void _es_hash_table_alloc(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t cap) {
+    ht->entries = NULL;
+    _es_da_init(&ht->entries, layout->entry_size, ht->allocator);
+    _es_da_insert_arr_impl(&ht->entries, NULL, cap + 1, 0);
+
+    ht->ctrl = NULL;
+    es_da_init_allocator(ht->ctrl, ht->allocator);
+    es_da_append_n(ht->ctrl, (u8_t) _ES_HASH_TABLE_CTRL_EMPTY, cap);
+
+    ht->tombstones = 0;
+}
+
+static void _es_hash_table_free_old(_es_hash_table_head_t *ht) {
+    es_da_free(ht->old_entries);
+    es_da_free(ht->old_ctrl);
+    ht->old_entries = NULL;
+    ht->old_ctrl = NULL;
+    ht->migrated = 0;
+}
+
+// Move up to slots old slots into the current arrays. Moved slots become
+// tombstones so lookups falling back to the old arrays don't find them.
+static void _es_hash_table_migrate(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t slots) {
+    usize_t old_cap = es_da_count(ht->old_ctrl);
+    usize_t end = es_min(ht->migrated + slots, old_cap);
+    for (usize_t i = ht->migrated; i < end; i++) {
+        if (ht->old_ctrl[i] & 0x80) {
+            continue;
+        }
+        _es_hash_table_place(ht, layout, (u8_t *) ht->old_entries + i * layout->entry_size, ht->old_ctrl[i], _es_hash_table_slot_hash(ht, layout, ht->old_entries, i));
+        ht->old_ctrl[i] = _ES_HASH_TABLE_CTRL_TOMBSTONE;
+    }
+
+    ht->migrated = end;
+    if (ht->migrated == old_cap) {
+        _es_hash_table_free_old(ht);
+    }
+}
+
+// Grow or purge tombstones when the load factor is reached. Incremental
+// tables keep the old arrays around and migrate them over later operations.
+static void _es_hash_table_grow(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout) {
+    usize_t cap = es_da_count(ht->ctrl);
+    if (ht->count + ht->tombstones + 1 <= cap * ht->max_load) {
+        return;
+    }
+    if (ht->count + 1 > cap * ht->max_load / 2) {
+        cap *= 2;
+    }
+
+    if (!ht->incremental) {
+        _es_hash_table_rehash_impl(ht, layout, cap);
+        return;
+    }
+
+    if (ht->old_ctrl != NULL) {
+        _es_hash_table_migrate(ht, layout, es_da_count(ht->old_ctrl));
+    }
+    ht->old_entries = ht->entries;
+    ht->old_ctrl = ht->ctrl;
+    ht->migrated = 0;
+    _es_hash_table_alloc(ht, layout, cap);
+}
+
+// Lookups never migrate, so a table nobody writes to can be read from several threads.
+void *_es_hash_table_lookup_impl(const _es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t hash, const void *key) {
+    usize_t cap = es_da_count(ht->ctrl);
+    usize_t index = _es_hash_table_find(layout, ht->entries, ht->ctrl, cap, hash, key);
+    if (index < cap) {
+        return (u8_t *) ht->entries + index * layout->entry_size;
+    }
+
+    if (ht->old_ctrl != NULL) {
+        usize_t old_cap = es_da_count(ht->old_ctrl);
+        index = _es_hash_table_find(layout, ht->old_entries, ht->old_ctrl, old_cap, hash, key);
+        if (index < old_cap) {
+            return (u8_t *) ht->old_entries + index * layout->entry_size;
         }
     }
+
+    return NULL;
+}
+
+// Hash a key the way the table does.
+static usize_t _es_hash_table_key_hash(const _es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, const void *key) {
+    return _es_hash_table_hash_key(ht->hash_func, layout->string_key, key, layout->key_size);
+}
+
+void *_es_hash_table_get_impl(const _es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, const void *key) {
+    void *entry = _es_hash_table_lookup_impl(ht, layout, _es_hash_table_key_hash(ht, layout, key), key);
+    if (entry == NULL) {
+        return (u8_t *) ht->entries + es_da_count(ht->ctrl) * layout->entry_size;
+    }
+    return entry;
+}
+
+b8_t _es_hash_table_contains_impl(const _es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, const void *key) {
+    return _es_hash_table_lookup_impl(ht, layout, _es_hash_table_key_hash(ht, layout, key), key) != NULL;
+}
+
+void *_es_hash_table_claim_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t hash, const void *key) {
+    _es_hash_table_grow(ht, layout);
+    if (ht->old_ctrl != NULL) {
+        _es_hash_table_migrate(ht, layout, ES_HASH_TABLE_MIGRATE_SLOTS);
+    }
+
+    usize_t cap = es_da_count(ht->ctrl);
+    usize_t index = _es_hash_table_find(layout, ht->entries, ht->ctrl, cap, hash, key);
+    if (index < cap) {
+        return (u8_t *) ht->entries + index * layout->entry_size;
+    }
+
+    // Keys still in the old arrays are moved over, keeping the count.
+    if (ht->old_ctrl != NULL) {
+        usize_t old_cap = es_da_count(ht->old_ctrl);
+        index = _es_hash_table_find(layout, ht->old_entries, ht->old_ctrl, old_cap, hash, key);
+        if (index < old_cap) {
+            void *entry = _es_hash_table_place(ht, layout, (u8_t *) ht->old_entries + index * layout->entry_size, ht->old_ctrl[index], hash);
+            ht->old_ctrl[index] = _ES_HASH_TABLE_CTRL_TOMBSTONE;
+            return entry;
+        }
+    }
+
+    ht->count++;
+    return _es_hash_table_place(ht, layout, NULL, _es_hash_table_h2(hash), hash);
+}
+
+void _es_hash_table_remove_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t hash, const void *key) {
+    if (ht->old_ctrl != NULL) {
+        _es_hash_table_migrate(ht, layout, ES_HASH_TABLE_MIGRATE_SLOTS);
+    }
+
+    usize_t cap = es_da_count(ht->ctrl);
+    usize_t index = _es_hash_table_find(layout, ht->entries, ht->ctrl, cap, hash, key);
+    if (index < cap) {
+        _es_hash_table_remove_index_impl(ht, layout, index);
+        return;
+    }
+
+    if (ht->old_ctrl != NULL) {
+        usize_t old_cap = es_da_count(ht->old_ctrl);
+        index = _es_hash_table_find(layout, ht->old_entries, ht->old_ctrl, old_cap, hash, key);
+        if (index < old_cap) {
+            _es_hash_table_erase(layout, ht->old_entries, ht->old_ctrl, index);
+            ht->count--;
+        }
+    }
+}
+
+void _es_hash_table_remove_index_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t index) {
+    if (index >= es_da_count(ht->ctrl) || ht->ctrl[index] & 0x80) {
+        return;
+    }
+
+    if (_es_hash_table_erase(layout, ht->entries, ht->ctrl, index)) {
+        ht->tombstones++;
+    }
+    ht->count--;
+}
+
+void _es_hash_table_rehash_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t cap) {
+    void *entries = ht->entries;
+    es_da(u8_t) ctrl = ht->ctrl;
+    _es_hash_table_alloc(ht, layout, cap);
+
+    // Keys are unique and there are no tombstones yet, so entries go in the first free slot.
+    for (usize_t i = 0; i < es_da_count(ctrl); i++) {
+        if (!(ctrl[i] & 0x80)) {
+            _es_hash_table_place(ht, layout, (u8_t *) entries + i * layout->entry_size, ctrl[i], _es_hash_table_slot_hash(ht, layout, entries, i));
+        }
+    }
+    if (ht->old_ctrl != NULL) {
+        _es_hash_table_migrate(ht, layout, es_da_count(ht->old_ctrl));
+    }
+
+    es_da_free(entries);
+    es_da_free(ctrl);
+}
+
+void _es_hash_table_reserve_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout, usize_t count) {
+    usize_t cap = _es_hash_table_cap_for(count, ht->max_load);
+    if (cap > es_da_count(ht->ctrl)) {
+        _es_hash_table_rehash_impl(ht, layout, cap);
+    }
+}
+
+void _es_hash_table_clear_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout) {
+    _es_hash_table_free_old(ht);
+    memset(ht->entries, 0, (es_da_count(ht->ctrl) + 1) * layout->entry_size);
+    memset(ht->ctrl, _ES_HASH_TABLE_CTRL_EMPTY, es_da_count(ht->ctrl));
+    ht->count = 0;
+    ht->tombstones = 0;
+}
+
+void _es_hash_table_free_impl(_es_hash_table_head_t *ht) {
+    _es_hash_table_free_old(ht);
+    es_da_free(ht->entries);
+    es_da_free(ht->ctrl);
+}
+
+usize_t _es_hash_table_cap_for(usize_t count, f32_t max_load) {
+    usize_t cap = _ES_HASH_TABLE_GROUP;
+    while (count + 1 > cap * max_load) {
+        cap <<= 1;
+    }
     return cap;
 }
 
-void _es_hash_table_iter_advance_impl(usize_t state_stride, usize_t entry_size, const void *entries, usize_t *iter, usize_t cap) {
-    _es_hash_table_entry_state_t state = _ES_HASH_TABLE_ENTRY_DEAD;
-    while (state == _ES_HASH_TABLE_ENTRY_DEAD) {
+// Hash value differently dependant on what key type the hash table uses.
+usize_t _es_hash_table_hash_key(es_hash_func_t func, b8_t is_string, const void *key, usize_t len) {
+    if (func == NULL) {
+        func = es_siphash;
+    }
+    if (is_string) {
+        const char *str = *(const char **) key;
+        return func(str, es_cstr_len(str), ES_HASH_TABLE_SEED);
+    }
+    return func(key, len, ES_HASH_TABLE_SEED);
+}
+
+void _es_hash_table_finish_rehash_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout) {
+    if (ht->old_ctrl != NULL) {
+        _es_hash_table_migrate(ht, layout, es_da_count(ht->old_ctrl));
+    }
+}
+
+usize_t _es_hash_table_iter_new_impl(_es_hash_table_head_t *ht, const _es_hash_table_layout_t *layout) {
+    _es_hash_table_finish_rehash_impl(ht, layout);
+
+    usize_t iter = 0;
+    usize_t cap = es_da_count(ht->ctrl);
+    if (cap > 0 && ht->ctrl[0] & 0x80) {
+        _es_hash_table_iter_advance_impl(ht->ctrl, &iter, cap);
+    }
+    return iter;
+}
+
+void _es_hash_table_iter_advance_impl(const u8_t *ctrl, usize_t *iter, usize_t cap) {
+    do {
         (*iter)++;
-        if (*iter >= cap) {
-            break;
+    } while (*iter < cap && ctrl[*iter] & 0x80);
+}
+
+//
+// Hash multimap
+//
+
+#define _es_hash_multimap_run(LAYOUT, ENTRIES, I) \
+    ((_es_hash_multimap_run_t *) ((u8_t *) (ENTRIES) + (I) * (LAYOUT)->entry_size + (LAYOUT)->value_offset))
+
+// Copy the runs of alive entries next to each other in a new value array.
+static void _es_hash_multimap_compact_runs(const _es_hash_table_layout_t *layout, void *entries, const u8_t *ctrl, usize_t start, usize_t cap, const u8_t *values, u8_t *compacted, usize_t *next, usize_t value_size) {
+    for (usize_t i = start; i < cap; i++) {
+        if (ctrl[i] & 0x80) {
+            continue;
+        }
+        _es_hash_multimap_run_t *run = _es_hash_multimap_run(layout, entries, i);
+        memcpy(compacted + *next * value_size, values + run->start * value_size, run->count * value_size);
+        run->start = *next;
+        run->cap = run->count;
+        *next += run->count;
+    }
+}
+
+// Move every run to the front of a new value array and return it.
+static void *_es_hash_multimap_compact(_es_hash_table_head_t *keys, const _es_hash_table_layout_t *layout, void *values, usize_t count) {
+    usize_t value_size = _es_da_head(values)->size;
+    void *compacted = NULL;
+    _es_da_init(&compacted, value_size, keys->allocator);
+    _es_da_resize_uninit_impl(&compacted, count);
+
+    // Keys waiting on an incremental rehash keep their runs too.
+    usize_t next = 0;
+    _es_hash_multimap_compact_runs(layout, keys->entries, keys->ctrl, 0, es_da_count(keys->ctrl), values, compacted, &next, value_size);
+    if (keys->old_ctrl != NULL) {
+        _es_hash_multimap_compact_runs(layout, keys->old_entries, keys->old_ctrl, keys->migrated, es_da_count(keys->old_ctrl), values, compacted, &next, value_size);
+    }
+
+    es_da_free(values);
+    return compacted;
+}
+
+// Add n uninitialized values to the end of the value array, growing it geometrically.
+static void *_es_hash_multimap_extend(void *values, usize_t n) {
+    _es_da_resize(&values, n);
+    _es_da_head(values)->count += n;
+    return values;
+}
+
+void *_es_hash_multimap_push_impl(_es_hash_table_head_t *keys, const _es_hash_table_layout_t *layout, void *values, usize_t *count, usize_t *holes, usize_t hash, const void *key, usize_t *index) {
+    usize_t key_count = keys->count;
+    u8_t *entry = _es_hash_table_claim_impl(keys, layout, hash, key);
+    _es_hash_multimap_run_t *run = (_es_hash_multimap_run_t *) (entry + layout->value_offset);
+    if (keys->count != key_count) {
+        memcpy(entry + layout->key_offset, key, layout->key_size);
+        *(usize_t *) (entry + layout->hash_offset) = hash;
+        memset(run, 0, sizeof(*run));
+    }
+
+    if (run->count == run->cap) {
+        // Relocated runs leave holes behind, so memory stays within a constant factor of the values.
+        if (*holes > *count) {
+            values = _es_hash_multimap_compact(keys, layout, values, *count);
+            *holes = 0;
+        }
+
+        usize_t value_size = _es_da_head(values)->size;
+        usize_t end = es_da_count(values);
+        usize_t cap = run->cap == 0 ? 1 : run->cap * 2;
+        if (run->cap != 0 && run->start + run->cap == end) {
+            // The last run grows in place.
+            values = _es_hash_multimap_extend(values, cap - run->cap);
+        } else {
+            values = _es_hash_multimap_extend(values, cap);
+            u8_t *bytes = values;
+            memcpy(bytes + end * value_size, bytes + run->start * value_size, run->count * value_size);
+            *holes += run->cap;
+            run->start = end;
         }
-        state = *((_es_hash_table_entry_state_t *) ((u8_t *) entries + *iter * entry_size + state_stride));
+        run->cap = cap;
+    }
+
+    (*count)++;
+    *index = run->start + run->count++;
+    return values;
+}
+
+void *_es_hash_multimap_get_impl(_es_hash_table_head_t *keys, const _es_hash_table_layout_t *layout, void *values, const void *key, usize_t *count) {
+    u8_t *entry = _es_hash_table_lookup_impl(keys, layout, _es_hash_table_key_hash(keys, layout, key), key);
+    if (entry == NULL) {
+        *count = 0;
+        return NULL;
+    }
+
+    const _es_hash_multimap_run_t *run = (const _es_hash_multimap_run_t *) (entry + layout->value_offset);
+    *count = run->count;
+    return (u8_t *) values + run->start * _es_da_head(values)->size;
+}
+
+void _es_hash_multimap_remove_impl(_es_hash_table_head_t *keys, const _es_hash_table_layout_t *layout, usize_t *count, usize_t *holes, usize_t hash, const void *key) {
+    u8_t *entry = _es_hash_table_lookup_impl(keys, layout, hash, key);
+    if (entry == NULL) {
+        return;
     }
+
+    const _es_hash_multimap_run_t *run = (const _es_hash_multimap_run_t *) (entry + layout->value_offset);
+    *holes += run->cap;
+    *count -= run->count;
+    _es_hash_table_remove_impl(keys, layout, hash, key);
 }
 
 /*=========================*/
@@ -468,251 +2124,2630 @@ void es_mutex_lock(es_mutex_t *mutex) {
     WaitForSingleObject(mutex->handle, INFINITE);
 }
 
-void es_mutex_unlock(es_mutex_t *mutex) {
-    ReleaseMutex(mutex->handle);
+void es_mutex_unlock(es_mutex_t *mutex) {
+    ReleaseMutex(mutex->handle);
+}
+
+#endif // ES_OS_WIN32
+
+/*=========================*/
+// Pool
+/*=========================*/
+
+es_pool_t es_pool_init(usize_t block_size, usize_t slab_blocks) {
+    es_pool_t pool = {0};
+    pool.block_size = _es_pool_align(es_max(block_size, sizeof(_es_pool_block_t)));
+    pool.slab_blocks = slab_blocks != 0 ? slab_blocks : ES_POOL_SLAB_BLOCKS;
+    pool.mutex = es_mutex_init();
+    return pool;
+}
+
+void es_pool_free(es_pool_t *pool) {
+    es_assert(pool != NULL, "Can't free a NULL pool.", NULL);
+
+    _es_pool_slab_t *slab = pool->slab;
+    while (slab != NULL) {
+        _es_pool_slab_t *prev = slab->prev;
+        es_free(slab);
+        slab = prev;
+    }
+    pool->slab = NULL;
+    pool->free_list = NULL;
+    es_mutex_free(&pool->mutex);
+}
+
+void _es_pool_grow(es_pool_t *pool) {
+    _es_pool_slab_t *slab = es_malloc(_es_pool_align(sizeof(_es_pool_slab_t)) + pool->block_size * pool->slab_blocks);
+    if (slab == NULL) {
+        return;
+    }
+    slab->prev = pool->slab;
+    pool->slab = slab;
+
+    // Link blocks back to front so they're handed out in address order.
+    u8_t *ptr = _es_pool_slab_ptr(slab);
+    for (usize_t i = pool->slab_blocks; i > 0; i--) {
+        _es_pool_block_t *block = (_es_pool_block_t *) (ptr + (i - 1) * pool->block_size);
+        block->next = pool->free_list;
+        pool->free_list = block;
+    }
+}
+
+void *es_pool_alloc(es_pool_t *pool) {
+    es_assert(pool != NULL, "Can't allocate from a NULL pool.", NULL);
+
+    es_mutex_lock(&pool->mutex);
+    if (pool->free_list == NULL) {
+        _es_pool_grow(pool);
+    }
+    _es_pool_block_t *block = pool->free_list;
+    if (block != NULL) {
+        pool->free_list = block->next;
+    }
+    es_mutex_unlock(&pool->mutex);
+
+    return block;
+}
+
+void es_pool_release(es_pool_t *pool, void *ptr) {
+    es_assert(pool != NULL, "Can't release to a NULL pool.", NULL);
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    _es_pool_block_t *block = ptr;
+    es_mutex_lock(&pool->mutex);
+    block->next = pool->free_list;
+    pool->free_list = block;
+    es_mutex_unlock(&pool->mutex);
+}
+
+const es_allocator_t *es_pool_allocator(es_pool_t *pool) {
+    es_assert(pool != NULL, "Can't get allocator of a NULL pool.", NULL);
+
+    pool->allocator.alloc = _es_pool_allocator_alloc;
+    pool->allocator.realloc = _es_pool_allocator_realloc;
+    pool->allocator.free = _es_pool_allocator_free;
+    pool->allocator.user = pool;
+
+    return &pool->allocator;
+}
+
+void *_es_pool_allocator_alloc(usize_t size, void *user) {
+    es_pool_t *pool = user;
+    es_assert(size <= pool->block_size, "Allocation of %lu bytes exceeds pool block size.", size);
+    return es_pool_alloc(pool);
+}
+
+void *_es_pool_allocator_realloc(void *ptr, usize_t old_size, usize_t new_size, void *user) {
+    (void) old_size;
+    es_pool_t *pool = user;
+    es_assert(new_size <= pool->block_size, "Allocation of %lu bytes exceeds pool block size.", new_size);
+    if (ptr == NULL) {
+        return es_pool_alloc(pool);
+    }
+    return ptr;
+}
+
+void _es_pool_allocator_free(void *ptr, usize_t size, void *user) {
+    (void) size;
+    es_pool_release(user, ptr);
+}
+
+es_pool_cache_t es_pool_cache_init(es_pool_t *pool) {
+    es_pool_cache_t cache = {0};
+    cache.pool = pool;
+    return cache;
+}
+
+void es_pool_cache_flush(es_pool_cache_t *cache) {
+    if (cache->count == 0) {
+        return;
+    }
+
+    es_mutex_lock(&cache->pool->mutex);
+    while (cache->count > 0) {
+        _es_pool_block_t *block = cache->blocks[--cache->count];
+        block->next = cache->pool->free_list;
+        cache->pool->free_list = block;
+    }
+    es_mutex_unlock(&cache->pool->mutex);
+}
+
+void *es_pool_cache_alloc(es_pool_cache_t *cache) {
+    // Refill half the cache in one locked batch.
+    if (cache->count == 0) {
+        es_pool_t *pool = cache->pool;
+        es_mutex_lock(&pool->mutex);
+        while (cache->count < ES_POOL_CACHE_SIZE / 2) {
+            if (pool->free_list == NULL) {
+                _es_pool_grow(pool);
+                if (pool->free_list == NULL) {
+                    break;
+                }
+            }
+            cache->blocks[cache->count++] = pool->free_list;
+            pool->free_list = pool->free_list->next;
+        }
+        es_mutex_unlock(&pool->mutex);
+
+        if (cache->count == 0) {
+            return NULL;
+        }
+    }
+
+    return cache->blocks[--cache->count];
+}
+
+void es_pool_cache_release(es_pool_cache_t *cache, void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    // Flush half the cache in one locked batch.
+    if (cache->count == ES_POOL_CACHE_SIZE) {
+        es_pool_t *pool = cache->pool;
+        es_mutex_lock(&pool->mutex);
+        while (cache->count > ES_POOL_CACHE_SIZE / 2) {
+            _es_pool_block_t *block = cache->blocks[--cache->count];
+            block->next = pool->free_list;
+            pool->free_list = block;
+        }
+        es_mutex_unlock(&pool->mutex);
+    }
+
+    cache->blocks[cache->count++] = ptr;
+}
+
+/*=========================*/
+// Concurrent hash table
+/*=========================*/
+
+// Shards are picked from the top bits of the mixed hash, which the shard
+// tables don't use for their own probing.
+static _es_chash_table_shard_t *_es_chash_table_shard(_es_chash_table_shard_t *shards, usize_t hash) {
+    u64_t mixed = (u64_t) hash * 0x9e3779b97f4a7c15ull;
+    return &shards[mixed >> (64 - ES_CHASH_TABLE_SHARD_BITS)];
+}
+
+static usize_t _es_chash_table_hash(_es_chash_table_shard_t *shards, const _es_hash_table_layout_t *layout, const void *key) {
+    return _es_hash_table_hash_key(shards[0].table.hash_func, layout->string_key, key, layout->key_size);
+}
+
+void _es_chash_table_init_impl(_es_chash_table_shard_t *shards, const _es_hash_table_layout_t *layout, const es_allocator_t *allocator) {
+    for (usize_t i = 0; i < ES_CHASH_TABLE_SHARDS; i++) {
+        _es_hash_table_head_t *table = &shards[i].table;
+        table->max_load = ES_HASH_TABLE_MAX_LOAD;
+        table->string_key = layout->string_key;
+        table->allocator = allocator;
+        _es_hash_table_rehash_impl(table, layout, _ES_HASH_TABLE_GROUP);
+        shards[i].mutex = es_mutex_init();
+    }
+}
+
+void _es_chash_table_free_impl(_es_chash_table_shard_t *shards) {
+    for (usize_t i = 0; i < ES_CHASH_TABLE_SHARDS; i++) {
+        _es_hash_table_free_impl(&shards[i].table);
+        es_mutex_free(&shards[i].mutex);
+    }
+}
+
+void _es_chash_table_insert_impl(_es_chash_table_shard_t *shards, const _es_hash_table_layout_t *layout, const void *key, const void *value) {
+    usize_t hash = _es_chash_table_hash(shards, layout, key);
+    _es_chash_table_shard_t *shard = _es_chash_table_shard(shards, hash);
+
+    es_mutex_lock(&shard->mutex);
+    u8_t *entry = _es_hash_table_claim_impl(&shard->table, layout, hash, key);
+    memcpy(entry + layout->key_offset, key, layout->key_size);
+    memcpy(entry + layout->value_offset, value, layout->value_size);
+    *(usize_t *) (entry + layout->hash_offset) = hash;
+    es_mutex_unlock(&shard->mutex);
+}
+
+b8_t _es_chash_table_get_impl(_es_chash_table_shard_t *shards, const _es_hash_table_layout_t *layout, const void *key, void *out) {
+    usize_t hash = _es_chash_table_hash(shards, layout, key);
+    _es_chash_table_shard_t *shard = _es_chash_table_shard(shards, hash);
+
+    es_mutex_lock(&shard->mutex);
+    u8_t *entry = _es_hash_table_lookup_impl(&shard->table, layout, hash, key);
+    if (entry != NULL && out != NULL) {
+        memcpy(out, entry + layout->value_offset, layout->value_size);
+    }
+    es_mutex_unlock(&shard->mutex);
+
+    return entry != NULL;
+}
+
+b8_t _es_chash_table_remove_impl(_es_chash_table_shard_t *shards, const _es_hash_table_layout_t *layout, const void *key) {
+    usize_t hash = _es_chash_table_hash(shards, layout, key);
+    _es_chash_table_shard_t *shard = _es_chash_table_shard(shards, hash);
+
+    es_mutex_lock(&shard->mutex);
+    usize_t count = shard->table.count;
+    _es_hash_table_remove_impl(&shard->table, layout, hash, key);
+    b8_t removed = shard->table.count != count;
+    es_mutex_unlock(&shard->mutex);
+
+    return removed;
+}
+
+void _es_chash_table_upsert_impl(_es_chash_table_shard_t *shards, const _es_hash_table_layout_t *layout, const void *key, es_chash_table_upsert_func_t func, void *user) {
+    usize_t hash = _es_chash_table_hash(shards, layout, key);
+    _es_chash_table_shard_t *shard = _es_chash_table_shard(shards, hash);
+
+    es_mutex_lock(&shard->mutex);
+    usize_t count = shard->table.count;
+    u8_t *entry = _es_hash_table_claim_impl(&shard->table, layout, hash, key);
+    memcpy(entry + layout->key_offset, key, layout->key_size);
+    *(usize_t *) (entry + layout->hash_offset) = hash;
+    func(entry + layout->value_offset, shard->table.count == count, user);
+    es_mutex_unlock(&shard->mutex);
+}
+
+void _es_chash_table_reserve_impl(_es_chash_table_shard_t *shards, const _es_hash_table_layout_t *layout, usize_t count) {
+    // Leave some slack since keys don't spread perfectly evenly.
+    usize_t per_shard = count / ES_CHASH_TABLE_SHARDS + count / (ES_CHASH_TABLE_SHARDS * 8) + 1;
+    for (usize_t i = 0; i < ES_CHASH_TABLE_SHARDS; i++) {
+        es_mutex_lock(&shards[i].mutex);
+        _es_hash_table_reserve_impl(&shards[i].table, layout, per_shard);
+        es_mutex_unlock(&shards[i].mutex);
+    }
+}
+
+void _es_chash_table_hash_func_impl(_es_chash_table_shard_t *shards, es_hash_func_t func) {
+    es_assert(_es_chash_table_count_impl(shards) == 0, "Can't change the hash function of a hash table holding entries.", NULL);
+    for (usize_t i = 0; i < ES_CHASH_TABLE_SHARDS; i++) {
+        shards[i].table.hash_func = func;
+    }
+}
+
+usize_t _es_chash_table_count_impl(_es_chash_table_shard_t *shards) {
+    usize_t count = 0;
+    for (usize_t i = 0; i < ES_CHASH_TABLE_SHARDS; i++) {
+        es_mutex_lock(&shards[i].mutex);
+        count += shards[i].table.count;
+        es_mutex_unlock(&shards[i].mutex);
+    }
+    return count;
+}
+
+/*=========================*/
+// Strings
+/*=========================*/
+
+es_str_t es_strn_allocator(const char *str, usize_t len, const es_allocator_t *allocator) {
+    _es_str_head_t *head = _es_alloc(allocator, sizeof(_es_str_head_t) + len + 1);
+    head->len = len;
+    head->cap = len;
+    head->valid = true;
+    head->allocator = allocator;
+
+    es_str_t ptr = _es_str_ptr(head);
+    memcpy(ptr, str, len);
+    ptr[len] = '\0';
+
+    return ptr;
+}
+
+es_str_t es_str_allocator(const char *str, const es_allocator_t *allocator) {
+    return es_strn_allocator(str, es_cstr_len(str), allocator);
+}
+
+es_str_t es_strn_arena(const char *str, usize_t len, es_arena_t *arena) {
+    return es_strn_allocator(str, len, es_arena_allocator(arena));
+}
+
+es_str_t es_str_arena(const char *str, es_arena_t *arena) {
+    return es_strn_allocator(str, es_cstr_len(str), es_arena_allocator(arena));
+}
+
+es_str_t es_strn(const char *str, usize_t len) {
+    return es_strn_allocator(str, len, NULL);
+}
+
+es_str_t es_str(const char *str) {
+    return es_strn(str, es_cstr_len(str));
+}
+
+es_str_t es_str_empty(void) {
+    return es_strn("", 0);
+}
+
+es_str_t es_str_reserve(usize_t len) {
+    _es_str_head_t *head = es_malloc(sizeof(_es_str_head_t) + len + 1);
+    head->len = len;
+    head->cap = len;
+    head->valid = true;
+    head->allocator = NULL;
+
+    es_str_t ptr = _es_str_ptr(head);
+    memset(ptr, 0, len + 1);
+
+    return ptr;
+}
+
+es_str_t es_str_u64(u64_t value) {
+    char buf[ES_U64_BUF_SIZE];
+    usize_t len = es_u64_to_buf(value, buf);
+    return es_strn(buf, len);
+}
+es_str_t es_str_u32(u32_t value) { return es_str_u64(value); }
+es_str_t es_str_u16(u16_t value) { return es_str_u64(value); }
+es_str_t es_str_u8(u8_t value)   { return es_str_u64(value); }
+
+es_str_t es_str_i64(i64_t value) {
+    char buf[ES_I64_BUF_SIZE];
+    usize_t len = es_i64_to_buf(value, buf);
+    return es_strn(buf, len);
+}
+es_str_t es_str_i32(i32_t value) { return es_str_i64(value); }
+es_str_t es_str_i16(i16_t value) { return es_str_i64(value); }
+es_str_t es_str_i8(i8_t value)   { return es_str_i64(value); }
+
+es_str_t es_str_f64(f64_t value) {
+    char buf[ES_F64_BUF_SIZE];
+    usize_t len = es_f64_to_buf(value, buf);
+    return es_strn(buf, len);
+}
+
+es_str_t es_str_b8(b8_t value) {
+    return es_str(value ? "true" : "false");
+}
+
+es_str_t es_str_view(es_strview_t view) {
+    return es_strn(view.data, view.len);
+}
+
+void es_str_free(es_str_t *str) {
+    _es_str_head_t *head = _es_str_head(*str);
+    _es_free(head->allocator, head, sizeof(_es_str_head_t) + head->cap + 1);
+    *str = NULL;
+}
+
+void es_str_free_list(es_da(es_str_t) *list) {
+    for (usize_t i = 0; i < es_da_count(*list); i++) {
+        es_str_free(&(*list)[i]);
+    }
+    es_da_free(*list);
+}
+
+b8_t es_str_valid(const es_str_t str) {
+    if (str == NULL) {
+        return false;
+    }
+    return _es_str_head(str)->valid;
+}
+
+usize_t es_str_len(const es_str_t str) {
+    return _es_str_head(str)->len;
+}
+
+usize_t es_str_cap(const es_str_t str) {
+    return _es_str_head(str)->cap;
+}
+
+void es_str_concat_len(es_str_t *str, const char *end, usize_t len) {
+    usize_t orig_len = es_str_len(*str);
+    _es_str_resize(str, len);
+    if (!es_str_valid(*str)) {
+        return;
+    }
+    memcpy(*str + orig_len, end, len);
+    (*str)[orig_len + len] = '\0';
+}
+
+void es_str_concat(es_str_t *str, const char *end) {
+    es_str_concat_len(str, end, es_cstr_len(end));
+}
+
+void es_str_concat_char(es_str_t *str, char c) {
+    _es_str_resize(str, 1);
+    if (!es_str_valid(*str)) {
+        return;
+    }
+    (*str)[es_str_len(*str) - 1] = c;
+}
+
+void es_str_concat_view(es_str_t *str, es_strview_t view) {
+    es_str_concat_len(str, view.data, view.len);
+}
+
+void es_str_reverse(es_str_t *str) {
+    usize_t start = 0, end = es_str_len(*str) - 1;
+    while (start < end) {
+        char temp = (*str)[start];
+        (*str)[start] = (*str)[end];
+        (*str)[end] = temp;
+
+        start++;
+        end--;
+    }
+}
+
+es_str_t es_str_sub_start(const char *str, usize_t len) {
+    return es_str_sub_len(str, 0, len);
+}
+
+es_str_t es_str_sub_end(const char *str, usize_t len) {
+    return es_str_sub_len(str, es_cstr_len(str) - len, len);
+}
+
+es_str_t es_str_sub_index(const char *str, usize_t start, usize_t end) {
+    es_assert(start <= end, "Starting index can't be greater than end index.", NULL);
+    return es_str_sub_len(str, start, end - start + 1);
+}
+
+es_str_t es_str_sub_len(const char *str, usize_t start, usize_t len) {
+    es_str_t result = es_strn(str + start, len);
+    return result;
+}
+
+es_da(es_str_t) es_str_split_by_delim(const char *str, char delim) {
+    es_da(es_str_t) result = NULL;
+    es_str_split_by_delim_into(&result, str, delim);
+    return result;
+}
+
+void es_str_split_by_delim_into(es_da(es_str_t) *list, const char *str, char delim) {
+    es_strview_split_t split = es_strview_split(es_strview(str), delim);
+    es_strview_t field;
+    while (es_strview_split_next(&split, &field)) {
+        es_da_push(*list, es_str_view(field));
+    }
+}
+
+i32_t es_str_cmp(es_str_t str, const char *b) {
+    return es_cstr_cmp_len(str, b, es_str_len(str) + 1);
+}
+
+void _es_str_resize(es_str_t *str, usize_t len) {
+    _es_str_head_t *head = _es_str_head(*str);
+    usize_t new_len = head->len + len;
+    // Growing geometrically keeps building a string one piece at a time linear.
+    if (new_len > head->cap) {
+        _es_str_reserve(str, es_max(new_len, es_max(head->cap * 2, (usize_t) _ES_STR_MIN_CAP)));
+        head = _es_str_head(*str);
+        if (!head->valid) {
+            return;
+        }
+    }
+    head->len = new_len;
+    (*str)[head->len] = '\0';
+}
+
+void _es_str_reserve(es_str_t *str, usize_t cap) {
+    _es_str_head_t *head = _es_str_head(*str);
+    if (cap <= head->cap) {
+        return;
+    }
+
+    _es_str_head_t *new_head = _es_realloc(head->allocator, head, sizeof(_es_str_head_t) + head->cap + 1, sizeof(_es_str_head_t) + cap + 1);
+    if (new_head == NULL) {
+        head->valid = false;
+    } else {
+        head = new_head;
+        head->cap = cap;
+    }
+    *str = _es_str_ptr(head);
+}
+
+//
+// String kernels
+//
+
+// Byte loops under every length, compare and search. One table of kernels
+// is picked the first time any of them runs.
+typedef struct _es_str_kernels_t {
+    usize_t (*cstr_len)(const char *str);
+    i32_t (*cstr_cmp)(const char *a, const char *b, usize_t len);
+    usize_t (*find_char)(const char *data, usize_t len, char c);
+    usize_t (*find_any)(const char *data, usize_t len, const char *set, usize_t set_len);
+    usize_t (*find)(const char *data, usize_t len, const char *needle, usize_t needle_len);
+} _es_str_kernels_t;
+
+static usize_t _es_cstr_len_scalar(const char *str) {
+    usize_t len = 0;
+    while (str[len] != '\0') {
+        len++;
+    }
+    return len;
+}
+
+static i32_t _es_cstr_cmp_scalar(const char *a, const char *b, usize_t len) {
+    for (usize_t i = 0; i < len; i++) {
+        if (a[i] != b[i] || a[i] == '\0') {
+            return (u8_t) a[i] - (u8_t) b[i];
+        }
+    }
+    return 0;
+}
+
+static usize_t _es_find_char_scalar(const char *data, usize_t len, char c) {
+    for (usize_t i = 0; i < len; i++) {
+        if (data[i] == c) {
+            return i;
+        }
+    }
+    return len;
+}
+
+static usize_t _es_find_any_scalar(const char *data, usize_t len, const char *set, usize_t set_len) {
+    b8_t table[256] = {0};
+    for (usize_t i = 0; i < set_len; i++) {
+        table[(u8_t) set[i]] = true;
+    }
+    for (usize_t i = 0; i < len; i++) {
+        if (table[(u8_t) data[i]]) {
+            return i;
+        }
+    }
+    return len;
+}
+
+// Needle is at least one character and no longer than data.
+static usize_t _es_find_scalar(const char *data, usize_t len, const char *needle, usize_t needle_len) {
+    for (usize_t i = 0; i + needle_len <= len; i++) {
+        if (data[i] == needle[0] && memcmp(data + i + 1, needle + 1, needle_len - 1) == 0) {
+            return i;
+        }
+    }
+    return len;
+}
+
+static const _es_str_kernels_t _es_str_kernels_scalar = {
+    _es_cstr_len_scalar,
+    _es_cstr_cmp_scalar,
+    _es_find_char_scalar,
+    _es_find_any_scalar,
+    _es_find_scalar,
+};
+
+// Unaligned loads of W bytes at P are only safe when they stay within one page.
+#define _es_str_load_fits_page(P, W) (((usize_t) (P) & 4095) <= 4096 - (W))
+
+// Kernels that read past the terminator never leave the page, but AddressSanitizer
+// can't tell, so they aren't instrumented.
+#if defined(__SANITIZE_ADDRESS__)
+#define _ES_NO_ASAN __attribute__((no_sanitize_address))
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define _ES_NO_ASAN __attribute__((no_sanitize_address))
+#endif // __has_feature(address_sanitizer)
+#endif // __SANITIZE_ADDRESS__, __has_feature
+#ifndef _ES_NO_ASAN
+#define _ES_NO_ASAN
+#endif // _ES_NO_ASAN
+
+#ifdef ES_SIMD_SSE2
+// Aligned loads never cross a page, so reading past the terminator is safe.
+_ES_NO_ASAN static usize_t _es_cstr_len_sse2(const char *str) {
+    const char *block = (const char *) ((usize_t) str & ~(usize_t) 15);
+    __m128i zero = _mm_setzero_si128();
+    u32_t mask = (u32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *) block), zero)) >> (str - block);
+    while (mask == 0) {
+        block += 16;
+        mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *) block), zero));
+        if (mask != 0) {
+            return block - str + __builtin_ctz(mask);
+        }
+    }
+    return __builtin_ctz(mask);
+}
+
+_ES_NO_ASAN static i32_t _es_cstr_cmp_sse2(const char *a, const char *b, usize_t len) {
+    __m128i zero = _mm_setzero_si128();
+    usize_t i = 0;
+    while (len - i >= 16) {
+        // Strings ending right before a page boundary are stepped over one character at a time.
+        if (!_es_str_load_fits_page(a + i, 16) || !_es_str_load_fits_page(b + i, 16)) {
+            if (a[i] != b[i] || a[i] == '\0') {
+                return (u8_t) a[i] - (u8_t) b[i];
+            }
+            i++;
+            continue;
+        }
+
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+        u32_t mask = (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) ^ 0xffff) | _mm_movemask_epi8(_mm_cmpeq_epi8(va, zero));
+        if (mask != 0) {
+            i += __builtin_ctz(mask);
+            return (u8_t) a[i] - (u8_t) b[i];
+        }
+        i += 16;
+    }
+    return _es_cstr_cmp_scalar(a + i, b + i, len - i);
+}
+
+static usize_t _es_find_char_sse2(const char *data, usize_t len, char c) {
+    __m128i needle = _mm_set1_epi8(c);
+    usize_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        u32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (data + i)), needle));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + _es_find_char_scalar(data + i, len - i, c);
+}
+
+// Sets of up to 16 characters are compared against every block, larger ones use the scalar table.
+static usize_t _es_find_any_sse2(const char *data, usize_t len, const char *set, usize_t set_len) {
+    if (set_len > 16) {
+        return _es_find_any_scalar(data, len, set, set_len);
+    }
+
+    __m128i needles[16];
+    for (usize_t j = 0; j < set_len; j++) {
+        needles[j] = _mm_set1_epi8(set[j]);
+    }
+    usize_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *) (data + i));
+        __m128i hits = _mm_setzero_si128();
+        for (usize_t j = 0; j < set_len; j++) {
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, needles[j]));
+        }
+        u32_t mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + _es_find_any_scalar(data + i, len - i, set, set_len);
+}
+
+// Candidates have to match both the first and the last character of needle
+// before the rest is compared.
+static usize_t _es_find_sse2(const char *data, usize_t len, const char *needle, usize_t needle_len) {
+    __m128i first = _mm_set1_epi8(needle[0]);
+    __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+    usize_t i = 0;
+    for (; i + needle_len - 1 + 16 <= len; i += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i *) (data + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i *) (data + i + needle_len - 1));
+        u32_t mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+        for (; mask != 0; mask &= mask - 1) {
+            usize_t candidate = i + __builtin_ctz(mask);
+            if (memcmp(data + candidate + 1, needle + 1, needle_len - 1) == 0) {
+                return candidate;
+            }
+        }
+    }
+    return i + _es_find_scalar(data + i, len - i, needle, needle_len);
+}
+
+static const _es_str_kernels_t _es_str_kernels_sse2 = {
+    _es_cstr_len_sse2,
+    _es_cstr_cmp_sse2,
+    _es_find_char_sse2,
+    _es_find_any_sse2,
+    _es_find_sse2,
+};
+#endif // ES_SIMD_SSE2
+
+#ifdef ES_SIMD_AVX2_DISPATCH
+#define _ES_TARGET_AVX2 __attribute__((target("avx2")))
+
+// After reaching 128 byte alignment, four blocks are checked per iteration with a single branch.
+_ES_TARGET_AVX2 _ES_NO_ASAN static usize_t _es_cstr_len_avx2(const char *str) {
+    const char *block = (const char *) ((usize_t) str & ~(usize_t) 31);
+    __m256i zero = _mm256_setzero_si256();
+    u32_t mask = (u32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) block), zero)) >> (str - block);
+    if (mask != 0) {
+        return __builtin_ctz(mask);
+    }
+
+    for (block += 32; (usize_t) block & 127; block += 32) {
+        mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) block), zero));
+        if (mask != 0) {
+            return block - str + __builtin_ctz(mask);
+        }
+    }
+
+    // Groups are 128 byte aligned, so every load stays within one page.
+    for (;; block += 128) {
+        __m256i a = _mm256_load_si256((const __m256i *) block);
+        __m256i b = _mm256_load_si256((const __m256i *) (block + 32));
+        __m256i c = _mm256_load_si256((const __m256i *) (block + 64));
+        __m256i d = _mm256_load_si256((const __m256i *) (block + 96));
+        __m256i min = _mm256_min_epu8(_mm256_min_epu8(a, b), _mm256_min_epu8(c, d));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(min, zero)) == 0) {
+            continue;
+        }
+
+        u64_t low = (u32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, zero)) | (u64_t) (u32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(b, zero)) << 32;
+        if (low != 0) {
+            return block - str + __builtin_ctzll(low);
+        }
+        u64_t high = (u32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(c, zero)) | (u64_t) (u32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(d, zero)) << 32;
+        return block - str + 64 + __builtin_ctzll(high);
+    }
+}
+
+_ES_TARGET_AVX2 static usize_t _es_find_char_avx2(const char *data, usize_t len, char c) {
+    __m256i needle = _mm256_set1_epi8(c);
+    usize_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        u32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (data + i)), needle));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + _es_find_char_sse2(data + i, len - i, c);
+}
+
+_ES_TARGET_AVX2 static usize_t _es_find_any_avx2(const char *data, usize_t len, const char *set, usize_t set_len) {
+    if (set_len > 16) {
+        return _es_find_any_scalar(data, len, set, set_len);
+    }
+
+    __m256i needles[16];
+    for (usize_t j = 0; j < set_len; j++) {
+        needles[j] = _mm256_set1_epi8(set[j]);
+    }
+    usize_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *) (data + i));
+        __m256i hits = _mm256_setzero_si256();
+        for (usize_t j = 0; j < set_len; j++) {
+            hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, needles[j]));
+        }
+        u32_t mask = _mm256_movemask_epi8(hits);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + _es_find_any_sse2(data + i, len - i, set, set_len);
+}
+
+_ES_TARGET_AVX2 static usize_t _es_find_avx2(const char *data, usize_t len, const char *needle, usize_t needle_len) {
+    __m256i first = _mm256_set1_epi8(needle[0]);
+    __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+    usize_t i = 0;
+    for (; i + needle_len - 1 + 32 <= len; i += 32) {
+        __m256i block_first = _mm256_loadu_si256((const __m256i *) (data + i));
+        __m256i block_last = _mm256_loadu_si256((const __m256i *) (data + i + needle_len - 1));
+        u32_t mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)));
+        for (; mask != 0; mask &= mask - 1) {
+            usize_t candidate = i + __builtin_ctz(mask);
+            if (memcmp(data + candidate + 1, needle + 1, needle_len - 1) == 0) {
+                return candidate;
+            }
+        }
+    }
+    return i + _es_find_sse2(data + i, len - i, needle, needle_len);
+}
+
+// Comparing stops at the first difference, which is usually early, so it stays on SSE2.
+static const _es_str_kernels_t _es_str_kernels_avx2 = {
+    _es_cstr_len_avx2,
+    _es_cstr_cmp_sse2,
+    _es_find_char_avx2,
+    _es_find_any_avx2,
+    _es_find_avx2,
+};
+#endif // ES_SIMD_AVX2_DISPATCH
+
+// Every table this build has, paired with whether the CPU can run it.
+static const _es_str_kernels_t *_es_str_kernel_tables[] = {
+    &_es_str_kernels_scalar,
+#ifdef ES_SIMD_SSE2
+    &_es_str_kernels_sse2,
+#endif // ES_SIMD_SSE2
+#ifdef ES_SIMD_AVX2_DISPATCH
+    &_es_str_kernels_avx2,
+#endif // ES_SIMD_AVX2_DISPATCH
+};
+
+static b8_t _es_str_kernels_supported(const _es_str_kernels_t *kernels) {
+#ifdef ES_SIMD_AVX2_DISPATCH
+    if (kernels == &_es_str_kernels_avx2) {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }
+#endif // ES_SIMD_AVX2_DISPATCH
+    (void) kernels;
+    return true;
+}
+
+// Racing threads may all run the selection, but they store the same table atomically.
+static const _es_str_kernels_t *_es_str_kernels_g = NULL;
+
+static const _es_str_kernels_t *_es_str_kernels_pick(void) {
+    usize_t i = es_arr_len(_es_str_kernel_tables) - 1;
+    while (!_es_str_kernels_supported(_es_str_kernel_tables[i])) {
+        i--;
+    }
+    return _es_str_kernel_tables[i];
+}
+
+static const _es_str_kernels_t *_es_str_kernels(void) {
+    const _es_str_kernels_t *kernels = __atomic_load_n(&_es_str_kernels_g, __ATOMIC_ACQUIRE);
+    if (kernels != NULL) {
+        return kernels;
+    }
+
+    kernels = _es_str_kernels_pick();
+    __atomic_store_n(&_es_str_kernels_g, kernels, __ATOMIC_RELEASE);
+    return kernels;
+}
+
+// Test hooks, only declared by the string tests. Selecting swaps the kernels
+// under every thread, so nothing else may call them.
+usize_t _es_str_kernels_count(void);
+b8_t _es_str_kernels_select(isize_t index);
+
+usize_t _es_str_kernels_count(void) {
+    return es_arr_len(_es_str_kernel_tables);
+}
+
+b8_t _es_str_kernels_select(isize_t index) {
+    if (index < 0) {
+        __atomic_store_n(&_es_str_kernels_g, _es_str_kernels_pick(), __ATOMIC_RELEASE);
+        return true;
+    }
+    if ((usize_t) index >= es_arr_len(_es_str_kernel_tables) || !_es_str_kernels_supported(_es_str_kernel_tables[index])) {
+        return false;
+    }
+    __atomic_store_n(&_es_str_kernels_g, _es_str_kernel_tables[index], __ATOMIC_RELEASE);
+    return true;
+}
+
+usize_t es_cstr_len(const char *str) {
+    return _es_str_kernels()->cstr_len(str);
+}
+
+i32_t es_cstr_cmp_len(const char *a, const char *b, usize_t len) {
+    return _es_str_kernels()->cstr_cmp(a, b, len);
+}
+
+i32_t es_cstr_cmp(const char *a, const char *b) {
+    return _es_str_kernels()->cstr_cmp(a, b, (usize_t) -1);
+}
+
+b8_t es_is_whitespace(char c) {
+    return (c == ' ' || c == '\t' || c == '\f' || c == '\r' || c == '\n');
+}
+
+b8_t es_is_alpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+b8_t es_is_digit(char c) {
+    return (c >= '0' && c <= '9');
+}
+
+//
+// String builder
+//
+
+es_str_builder_t es_str_builder_allocator(const es_allocator_t *allocator) {
+    es_str_builder_t builder = {
+        .str = es_strn_allocator("", 0, allocator),
+    };
+    return builder;
+}
+
+es_str_builder_t es_str_builder(void) {
+    return es_str_builder_allocator(NULL);
+}
+
+void es_str_builder_reserve(es_str_builder_t *builder, usize_t len) {
+    es_assert(builder->str != NULL, "Can't use a finished string builder.", NULL);
+    _es_str_reserve(&builder->str, es_str_len(builder->str) + len);
+}
+
+void es_str_builder_append_len(es_str_builder_t *builder, const char *str, usize_t len) {
+    es_assert(builder->str != NULL, "Can't use a finished string builder.", NULL);
+    es_str_concat_len(&builder->str, str, len);
+}
+
+void es_str_builder_append(es_str_builder_t *builder, const char *str) {
+    es_str_builder_append_len(builder, str, es_cstr_len(str));
+}
+
+void es_str_builder_append_char(es_str_builder_t *builder, char c) {
+    es_assert(builder->str != NULL, "Can't use a finished string builder.", NULL);
+    es_str_concat_char(&builder->str, c);
+}
+
+void es_str_builder_appendf(es_str_builder_t *builder, const char *fmt, ...) {
+    es_assert(builder->str != NULL, "Can't use a finished string builder.", NULL);
+
+    // Format straight into the spare capacity, growing once if it doesn't fit.
+    usize_t len = es_str_len(builder->str);
+    usize_t spare = es_str_cap(builder->str) - len;
+    va_list ptr;
+    va_start(ptr, fmt);
+    i32_t written = vsnprintf(builder->str + len, spare + 1, fmt, ptr);
+    va_end(ptr);
+    if (written < 0) {
+        builder->str[len] = '\0';
+        return;
+    }
+
+    if ((usize_t) written > spare) {
+        _es_str_resize(&builder->str, written);
+        if (!es_str_valid(builder->str)) {
+            return;
+        }
+        va_start(ptr, fmt);
+        vsnprintf(builder->str + len, written + 1, fmt, ptr);
+        va_end(ptr);
+        return;
+    }
+    _es_str_head(builder->str)->len += written;
+}
+
+void es_str_builder_append_view(es_str_builder_t *builder, es_strview_t view) {
+    es_str_builder_append_len(builder, view.data, view.len);
+}
+
+usize_t es_str_builder_len(const es_str_builder_t *builder) {
+    return es_str_len(builder->str);
+}
+
+es_str_t es_str_builder_finish(es_str_builder_t *builder) {
+    es_str_t str = builder->str;
+    builder->str = NULL;
+    return str;
+}
+
+void es_str_builder_free(es_str_builder_t *builder) {
+    if (builder->str != NULL) {
+        es_str_free(&builder->str);
+    }
+}
+
+//
+// String view
+//
+
+es_strview_t es_strview(const char *str) {
+    return es_strview_len(str, es_cstr_len(str));
+}
+
+es_strview_t es_strview_len(const char *str, usize_t len) {
+    es_strview_t view = { str, len };
+    return view;
+}
+
+es_strview_t es_strview_str(const es_str_t str) {
+    return es_strview_len(str, es_str_len(str));
+}
+
+es_strview_t es_strview_sub(es_strview_t view, usize_t start, usize_t len) {
+    start = es_min(start, view.len);
+    return es_strview_len(view.data + start, es_min(len, view.len - start));
+}
+
+es_strview_t es_strview_skip(es_strview_t view, usize_t len) {
+    return es_strview_sub(view, len, view.len);
+}
+
+i32_t es_strview_cmp(es_strview_t a, es_strview_t b) {
+    i32_t result = memcmp(a.data, b.data, es_min(a.len, b.len));
+    if (result != 0) {
+        return result;
+    }
+    return (a.len > b.len) - (a.len < b.len);
+}
+
+b8_t es_strview_eq(es_strview_t a, es_strview_t b) {
+    return a.len == b.len && memcmp(a.data, b.data, a.len) == 0;
+}
+
+b8_t es_strview_eq_cstr(es_strview_t view, const char *str) {
+    return es_strview_eq(view, es_strview(str));
+}
+
+b8_t es_strview_starts_with(es_strview_t view, es_strview_t prefix) {
+    return view.len >= prefix.len && memcmp(view.data, prefix.data, prefix.len) == 0;
+}
+
+b8_t es_strview_ends_with(es_strview_t view, es_strview_t suffix) {
+    return view.len >= suffix.len && memcmp(view.data + view.len - suffix.len, suffix.data, suffix.len) == 0;
+}
+
+usize_t es_strview_find_char(es_strview_t view, char c) {
+    return _es_str_kernels()->find_char(view.data, view.len, c);
+}
+
+usize_t es_strview_find(es_strview_t view, es_strview_t needle) {
+    if (needle.len == 0) {
+        return 0;
+    }
+    if (needle.len > view.len) {
+        return view.len;
+    }
+    return _es_str_kernels()->find(view.data, view.len, needle.data, needle.len);
+}
+
+usize_t es_strview_find_any(es_strview_t view, es_strview_t set) {
+    return _es_str_kernels()->find_any(view.data, view.len, set.data, set.len);
+}
+
+es_strview_t es_strview_trim(es_strview_t view) {
+    return es_strview_trim_end(es_strview_trim_start(view));
+}
+
+es_strview_t es_strview_trim_start(es_strview_t view) {
+    usize_t start = 0;
+    while (start < view.len && es_is_whitespace(view.data[start])) {
+        start++;
+    }
+    return es_strview_skip(view, start);
+}
+
+es_strview_t es_strview_trim_end(es_strview_t view) {
+    while (view.len > 0 && es_is_whitespace(view.data[view.len - 1])) {
+        view.len--;
+    }
+    return view;
+}
+
+es_strview_split_t es_strview_split(es_strview_t view, char delim) {
+    es_strview_split_t split = {
+        .rest = view,
+        .delim = delim,
+    };
+    return split;
+}
+
+b8_t es_strview_split_next(es_strview_split_t *split, es_strview_t *field) {
+    if (split->done) {
+        return false;
+    }
+
+    usize_t end = es_strview_find_char(split->rest, split->delim);
+    *field = es_strview_sub(split->rest, 0, end);
+    // The field after the last delimiter is the final one, even when empty.
+    split->done = end == split->rest.len;
+    split->rest = es_strview_skip(split->rest, end + 1);
+    return true;
+}
+
+void es_strview_split_into(es_da(es_strview_t) *list, es_strview_t view, char delim) {
+    es_strview_split_t split = es_strview_split(view, delim);
+    es_strview_t field;
+    while (es_strview_split_next(&split, &field)) {
+        es_da_push(*list, field);
+    }
+}
+
+es_strview_tokenizer_t es_strview_tokenizer(es_strview_t view, es_strview_t delims) {
+    es_strview_tokenizer_t tokenizer = {
+        .rest = view,
+        .delims = delims,
+    };
+    return tokenizer;
+}
+
+b8_t es_strview_tokenizer_next(es_strview_tokenizer_t *tokenizer, es_strview_t *token) {
+    es_strview_t rest = tokenizer->rest;
+    usize_t start = 0;
+    while (start < rest.len && es_strview_find_char(tokenizer->delims, rest.data[start]) < tokenizer->delims.len) {
+        start++;
+    }
+    if (start == rest.len) {
+        tokenizer->rest = es_strview_skip(rest, start);
+        return false;
+    }
+
+    usize_t end = start + es_strview_find_any(es_strview_skip(rest, start), tokenizer->delims);
+    *token = es_strview_sub(rest, start, end - start);
+    tokenizer->rest = es_strview_skip(rest, end);
+    return true;
+}
+
+//
+// Small string
+//
+
+es_sstr_t es_sstrn(const char *str, usize_t len) {
+    es_sstr_t sstr = {0};
+    es_sstr_append_len(&sstr, str, len);
+    return sstr;
+}
+
+es_sstr_t es_sstr(const char *str) {
+    return es_sstrn(str, es_cstr_len(str));
+}
+
+es_sstr_t es_sstr_view(es_strview_t view) {
+    return es_sstrn(view.data, view.len);
+}
+
+es_sstr_t es_sstr_u64(u64_t value) {
+    char buf[ES_U64_BUF_SIZE];
+    usize_t len = es_u64_to_buf(value, buf);
+    return es_sstrn(buf, len);
+}
+
+es_sstr_t es_sstr_i64(i64_t value) {
+    char buf[ES_I64_BUF_SIZE];
+    usize_t len = es_i64_to_buf(value, buf);
+    return es_sstrn(buf, len);
+}
+
+es_sstr_t es_sstr_f64(f64_t value) {
+    char buf[ES_F64_BUF_SIZE];
+    usize_t len = es_f64_to_buf(value, buf);
+    return es_sstrn(buf, len);
+}
+
+es_sstr_t es_sstr_b8(b8_t value) {
+    return value ? es_sstrn("true", 4) : es_sstrn("false", 5);
+}
+
+void es_sstr_free(es_sstr_t *str) {
+    if (str->small.tag == _ES_SSTR_LARGE) {
+        es_free(str->large.data);
+    }
+    memset(str, 0, sizeof(*str));
+}
+
+usize_t es_sstr_len(const es_sstr_t *str) {
+    return str->small.tag == _ES_SSTR_LARGE ? str->large.len : str->small.tag;
+}
+
+b8_t es_sstr_is_inline(const es_sstr_t *str) {
+    return str->small.tag != _ES_SSTR_LARGE;
+}
+
+const char *es_sstr_cstr(const es_sstr_t *str) {
+    return str->small.tag == _ES_SSTR_LARGE ? str->large.data : str->small.data;
+}
+
+es_strview_t es_strview_sstr(const es_sstr_t *str) {
+    return es_strview_len(es_sstr_cstr(str), es_sstr_len(str));
+}
+
+i32_t es_sstr_cmp(const es_sstr_t *str, const char *b) {
+    return es_cstr_cmp_len(es_sstr_cstr(str), b, es_sstr_len(str) + 1);
+}
+
+// Make room for len characters, moving to the heap once they don't fit inline.
+// Returns NULL, leaving str unchanged, when memory runs out.
+static char *_es_sstr_reserve(es_sstr_t *str, usize_t len) {
+    if (str->small.tag != _ES_SSTR_LARGE) {
+        if (len <= ES_SSTR_CAP) {
+            return str->small.data;
+        }
+
+        u8_t cap_log2 = 5;
+        while (((usize_t) 1 << cap_log2) <= len) {
+            cap_log2++;
+        }
+        usize_t small_len = str->small.tag;
+        char *data = es_malloc((usize_t) 1 << cap_log2);
+        if (data == NULL) {
+            return NULL;
+        }
+        memcpy(data, str->small.data, small_len + 1);
+
+        str->large.tag = _ES_SSTR_LARGE;
+        str->large.cap_log2 = cap_log2;
+        str->large.data = data;
+        str->large.len = small_len;
+        return data;
+    }
+
+    if (len >= (usize_t) 1 << str->large.cap_log2) {
+        u8_t cap_log2 = str->large.cap_log2;
+        while (((usize_t) 1 << cap_log2) <= len) {
+            cap_log2++;
+        }
+        char *data = es_realloc(str->large.data, (usize_t) 1 << cap_log2);
+        if (data == NULL) {
+            return NULL;
+        }
+        str->large.data = data;
+        str->large.cap_log2 = cap_log2;
+    }
+    return str->large.data;
+}
+
+b8_t es_sstr_append_len(es_sstr_t *str, const char *end, usize_t len) {
+    usize_t old_len = es_sstr_len(str);
+
+    // Reserving may move the characters, so an end pointing into them is
+    // found again by its offset.
+    usize_t old_data = (usize_t) es_sstr_cstr(str);
+    usize_t offset = (usize_t) end - old_data;
+    b8_t aliased = (usize_t) end >= old_data && offset <= old_len;
+
+    char *data = _es_sstr_reserve(str, old_len + len);
+    if (data == NULL) {
+        return false;
+    }
+    if (aliased) {
+        end = data + offset;
+    }
+    memmove(data + old_len, end, len);
+    data[old_len + len] = '\0';
+
+    if (str->small.tag == _ES_SSTR_LARGE) {
+        str->large.len = old_len + len;
+    } else {
+        str->small.tag = old_len + len;
+    }
+    return true;
+}
+
+b8_t es_sstr_append(es_sstr_t *str, const char *end) {
+    return es_sstr_append_len(str, end, es_cstr_len(end));
 }
 
-#endif // ES_OS_WIN32
+b8_t es_sstr_append_char(es_sstr_t *str, char c) {
+    return es_sstr_append_len(str, &c, 1);
+}
 
-/*=========================*/
-// Strings
-/*=========================*/
+//
+// Number conversion
+//
 
-es_str_t es_strn(const char *str, usize_t len) {
-    _es_str_head_t *head = es_malloc(sizeof(_es_str_head_t) + len + 1);
-    head->len = len;
-    head->valid = true;
+static const char _es_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+ES_INLINE usize_t _es_u64_digit_count(u64_t value) {
+    usize_t count = 1;
+    for (;;) {
+        if (value < 10) { return count; }
+        if (value < 100) { return count + 1; }
+        if (value < 1000) { return count + 2; }
+        if (value < 10000) { return count + 3; }
+        value /= 10000;
+        count += 4;
+    }
+}
 
-    es_str_t ptr = _es_str_ptr(head);
-    memcpy(ptr, str, len);
-    ptr[len] = '\0';
+// Write the digits of value backwards from end, two at a time.
+ES_INLINE void _es_u64_digits(u64_t value, char *end) {
+    while (value >= 100) {
+        u64_t pair = value % 100;
+        value /= 100;
+        end -= 2;
+        memcpy(end, &_es_digit_pairs[pair * 2], 2);
+    }
+    if (value >= 10) {
+        memcpy(end - 2, &_es_digit_pairs[value * 2], 2);
+    } else {
+        end[-1] = '0' + value;
+    }
+}
 
-    return ptr;
+usize_t es_u64_to_buf(u64_t value, char *buf) {
+    usize_t len = _es_u64_digit_count(value);
+    _es_u64_digits(value, buf + len);
+    buf[len] = '\0';
+    return len;
 }
 
-es_str_t es_str(const char *str) {
-    return es_strn(str, es_cstr_len(str));
+usize_t es_i64_to_buf(i64_t value, char *buf) {
+    if (value >= 0) {
+        return es_u64_to_buf(value, buf);
+    }
+    // Negating as unsigned keeps the smallest value from overflowing.
+    buf[0] = '-';
+    return es_u64_to_buf(-(u64_t) value, buf + 1) + 1;
 }
 
-es_str_t es_str_empty(void) {
-    return es_strn("", 0);
+// Shortest float printing uses Grisu2 by Florian Loitsch. It always round trips
+// and gives the shortest digits for all but a tiny fraction of values, where it
+// gives one digit more.
+
+// Float with a 64 bit significand, f * 2^e.
+typedef struct _es_diyfp_t {
+    u64_t f;
+    i32_t e;
+} _es_diyfp_t;
+
+// Normalized powers of ten 10^k for every eighth k from -300 to 324.
+static const struct {
+    u64_t f;
+    i32_t e;
+    i32_t k;
+} _es_cached_powers[] = {
+    { 0xab70fe17c79ac6caull, -1060, -300 },
+    { 0xff77b1fcbebcdc4full, -1034, -292 },
+    { 0xbe5691ef416bd60cull, -1007, -284 },
+    { 0x8dd01fad907ffc3cull, -980, -276 },
+    { 0xd3515c2831559a83ull, -954, -268 },
+    { 0x9d71ac8fada6c9b5ull, -927, -260 },
+    { 0xea9c227723ee8bcbull, -901, -252 },
+    { 0xaecc49914078536dull, -874, -244 },
+    { 0x823c12795db6ce57ull, -847, -236 },
+    { 0xc21094364dfb5637ull, -821, -228 },
+    { 0x9096ea6f3848984full, -794, -220 },
+    { 0xd77485cb25823ac7ull, -768, -212 },
+    { 0xa086cfcd97bf97f4ull, -741, -204 },
+    { 0xef340a98172aace5ull, -715, -196 },
+    { 0xb23867fb2a35b28eull, -688, -188 },
+    { 0x84c8d4dfd2c63f3bull, -661, -180 },
+    { 0xc5dd44271ad3cdbaull, -635, -172 },
+    { 0x936b9fcebb25c996ull, -608, -164 },
+    { 0xdbac6c247d62a584ull, -582, -156 },
+    { 0xa3ab66580d5fdaf6ull, -555, -148 },
+    { 0xf3e2f893dec3f126ull, -529, -140 },
+    { 0xb5b5ada8aaff80b8ull, -502, -132 },
+    { 0x87625f056c7c4a8bull, -475, -124 },
+    { 0xc9bcff6034c13053ull, -449, -116 },
+    { 0x964e858c91ba2655ull, -422, -108 },
+    { 0xdff9772470297ebdull, -396, -100 },
+    { 0xa6dfbd9fb8e5b88full, -369, -92 },
+    { 0xf8a95fcf88747d94ull, -343, -84 },
+    { 0xb94470938fa89bcfull, -316, -76 },
+    { 0x8a08f0f8bf0f156bull, -289, -68 },
+    { 0xcdb02555653131b6ull, -263, -60 },
+    { 0x993fe2c6d07b7facull, -236, -52 },
+    { 0xe45c10c42a2b3b06ull, -210, -44 },
+    { 0xaa242499697392d3ull, -183, -36 },
+    { 0xfd87b5f28300ca0eull, -157, -28 },
+    { 0xbce5086492111aebull, -130, -20 },
+    { 0x8cbccc096f5088ccull, -103, -12 },
+    { 0xd1b71758e219652cull, -77, -4 },
+    { 0x9c40000000000000ull, -50, 4 },
+    { 0xe8d4a51000000000ull, -24, 12 },
+    { 0xad78ebc5ac620000ull, 3, 20 },
+    { 0x813f3978f8940984ull, 30, 28 },
+    { 0xc097ce7bc90715b3ull, 56, 36 },
+    { 0x8f7e32ce7bea5c70ull, 83, 44 },
+    { 0xd5d238a4abe98068ull, 109, 52 },
+    { 0x9f4f2726179a2245ull, 136, 60 },
+    { 0xed63a231d4c4fb27ull, 162, 68 },
+    { 0xb0de65388cc8ada8ull, 189, 76 },
+    { 0x83c7088e1aab65dbull, 216, 84 },
+    { 0xc45d1df942711d9aull, 242, 92 },
+    { 0x924d692ca61be758ull, 269, 100 },
+    { 0xda01ee641a708deaull, 295, 108 },
+    { 0xa26da3999aef774aull, 322, 116 },
+    { 0xf209787bb47d6b85ull, 348, 124 },
+    { 0xb454e4a179dd1877ull, 375, 132 },
+    { 0x865b86925b9bc5c2ull, 402, 140 },
+    { 0xc83553c5c8965d3dull, 428, 148 },
+    { 0x952ab45cfa97a0b3ull, 455, 156 },
+    { 0xde469fbd99a05fe3ull, 481, 164 },
+    { 0xa59bc234db398c25ull, 508, 172 },
+    { 0xf6c69a72a3989f5cull, 534, 180 },
+    { 0xb7dcbf5354e9beceull, 561, 188 },
+    { 0x88fcf317f22241e2ull, 588, 196 },
+    { 0xcc20ce9bd35c78a5ull, 614, 204 },
+    { 0x98165af37b2153dfull, 641, 212 },
+    { 0xe2a0b5dc971f303aull, 667, 220 },
+    { 0xa8d9d1535ce3b396ull, 694, 228 },
+    { 0xfb9b7cd9a4a7443cull, 720, 236 },
+    { 0xbb764c4ca7a44410ull, 747, 244 },
+    { 0x8bab8eefb6409c1aull, 774, 252 },
+    { 0xd01fef10a657842cull, 800, 260 },
+    { 0x9b10a4e5e9913129ull, 827, 268 },
+    { 0xe7109bfba19c0c9dull, 853, 276 },
+    { 0xac2820d9623bf429ull, 880, 284 },
+    { 0x80444b5e7aa7cf85ull, 907, 292 },
+    { 0xbf21e44003acdd2dull, 933, 300 },
+    { 0x8e679c2f5e44ff8full, 960, 308 },
+    { 0xd433179d9c8cb841ull, 986, 316 },
+    { 0x9e19db92b4e31ba9ull, 1013, 324 },};
+
+// Multiply keeping the rounded upper 64 bits of the significand.
+ES_INLINE _es_diyfp_t _es_diyfp_mul(_es_diyfp_t x, _es_diyfp_t y) {
+    u64_t lo = x.f;
+    u64_t hi = y.f;
+    _es_wymum(&lo, &hi);
+    return (_es_diyfp_t) { hi + (lo >> 63), x.e + y.e + 64 };
 }
 
-es_str_t es_str_reserve(usize_t len) {
-    _es_str_head_t *head = es_malloc(sizeof(_es_str_head_t) + len + 1);
-    head->len = len;
-    head->valid = true;
+ES_INLINE _es_diyfp_t _es_diyfp_normalize(_es_diyfp_t x) {
+    while ((x.f >> 63) == 0) {
+        x.f <<= 1;
+        x.e--;
+    }
+    return x;
+}
 
-    es_str_t ptr = _es_str_ptr(head);
-    memset(ptr, 0, len + 1);
+// Get the digits of a positive finite value into buf and the power of ten
+// they're scaled by. Returns the digit count, at most 17.
+static usize_t _es_grisu2(f64_t value, char *buf, i32_t *decimal_exponent) {
+    u64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    u64_t fraction = bits & ((1ull << 52) - 1);
+    i32_t exponent = (bits >> 52) & 0x7ff;
+
+    _es_diyfp_t v;
+    if (exponent == 0) {
+        v = (_es_diyfp_t) { fraction, 1 - 1075 };
+    } else {
+        v = (_es_diyfp_t) { fraction | (1ull << 52), exponent - 1075 };
+    }
 
-    return ptr;
-}
+    // Boundaries halfway to the neighbouring floats. The lower neighbour is
+    // closer when value is a power of two.
+    _es_diyfp_t plus = _es_diyfp_normalize((_es_diyfp_t) { 2 * v.f + 1, v.e - 1 });
+    _es_diyfp_t minus;
+    if (fraction == 0 && exponent > 1) {
+        minus = (_es_diyfp_t) { 4 * v.f - 1, v.e - 2 };
+    } else {
+        minus = (_es_diyfp_t) { 2 * v.f - 1, v.e - 1 };
+    }
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    // Scale by a cached power of ten so the upper boundary's exponent lands in
+    // [-60, -32], leaving its integral part in 32 bits.
+    i32_t f = -60 - plus.e - 1;
+    i32_t k = (f * 78913) / (1 << 18) + (f > 0);
+    usize_t index = (300 + k + 7) / 8;
+    _es_diyfp_t c = { _es_cached_powers[index].f, _es_cached_powers[index].e };
+    *decimal_exponent = -_es_cached_powers[index].k;
+
+    _es_diyfp_t w = _es_diyfp_mul(_es_diyfp_normalize(v), c);
+    _es_diyfp_t w_minus = _es_diyfp_mul(minus, c);
+    _es_diyfp_t w_plus = _es_diyfp_mul(plus, c);
+    // Shrink the interval by one unit to stay safe from the rounding in the
+    // multiplications.
+    w_minus.f++;
+    w_plus.f--;
+
+    u64_t delta = w_plus.f - w_minus.f;
+    u64_t dist = w_plus.f - w.f;
+    i32_t shift = -w_plus.e;
+    u64_t one = 1ull << shift;
+    u32_t p1 = (u32_t) (w_plus.f >> shift);
+    u64_t p2 = w_plus.f & (one - 1);
+
+    u32_t pow10 = 1;
+    i32_t n = 1;
+    while (n < 10 && p1 / pow10 >= 10) {
+        pow10 *= 10;
+        n++;
+    }
 
-es_str_t es_str_u64(u64_t value) {
-    // Extract numbers.
-    es_str_t final = es_str_empty();
-    for (u64_t i = value; i != 0; i /= 10) {
-        es_str_concat_char(&final, '0' + i % 10);
+    // Generate integral digits until the rest falls inside the interval.
+    usize_t len = 0;
+    u64_t rest = 0;
+    u64_t ten_k = 0;
+    while (n > 0) {
+        buf[len++] = '0' + p1 / pow10;
+        p1 %= pow10;
+        n--;
+        rest = ((u64_t) p1 << shift) + p2;
+        if (rest <= delta) {
+            *decimal_exponent += n;
+            ten_k = (u64_t) pow10 << shift;
+            break;
+        }
+        pow10 /= 10;
     }
-    // Handle 0.
-    if (value == 0) {
-        es_str_concat_char(&final, '0');
+
+    // Then fractional digits.
+    if (rest > delta) {
+        i32_t m = 0;
+        do {
+            p2 *= 10;
+            buf[len++] = '0' + (p2 >> shift);
+            p2 &= one - 1;
+            delta *= 10;
+            dist *= 10;
+            m++;
+        } while (p2 > delta);
+        *decimal_exponent -= m;
+        rest = p2;
+        ten_k = one;
     }
 
-    es_str_reverse(&final);
+    // Round the last digit towards value while staying inside the interval.
+    while (rest < dist && delta - rest >= ten_k &&
+           (rest + ten_k < dist || dist - rest > rest + ten_k - dist)) {
+        buf[len - 1]--;
+        rest += ten_k;
+    }
 
-    return final;
+    return len;
 }
-es_str_t es_str_u32(u32_t value) { return es_str_u64(value); }
-es_str_t es_str_u16(u16_t value) { return es_str_u64(value); }
-es_str_t es_str_u8(u8_t value)   { return es_str_u64(value); }
 
-es_str_t es_str_i64(i64_t value) {
-    es_str_t final = es_str_empty();
-    // Check for negative.
-    b8_t negative = false;
-    if (value < 0) {
-        value = -value;
-        negative = true;
-    }
+usize_t es_f64_to_buf(f64_t value, char *buf) {
+    u64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    char *start = buf;
 
-    // Extract numbers.
-    for (i64_t i = value; i != 0; i /= 10) {
-        es_str_concat_char(&final, '0' + i % 10);
+    if ((bits & 0x7ff0000000000000ull) == 0x7ff0000000000000ull) {
+        if (bits & ((1ull << 52) - 1)) {
+            memcpy(buf, "nan", 4);
+            return 3;
+        }
+        if (bits >> 63) {
+            *buf++ = '-';
+        }
+        memcpy(buf, "inf", 4);
+        return buf + 3 - start;
     }
-    // Handle 0.
-    if (value == 0) {
-        es_str_concat_char(&final, '0');
+    if (bits >> 63) {
+        *buf++ = '-';
+        value = -value;
     }
-
-    // Append a minus if value is negative.
-    if (negative) {
-        es_str_concat_char(&final, '-');
+    if (value == 0.0) {
+        memcpy(buf, "0", 2);
+        return buf + 1 - start;
     }
 
-    es_str_reverse(&final);
+    i32_t decimal_exponent;
+    i32_t len = _es_grisu2(value, buf, &decimal_exponent);
+    // Position of the decimal point relative to the first digit.
+    i32_t point = len + decimal_exponent;
+
+    if (len <= point && point <= 21) {
+        // 1234e3 -> 1234000
+        memset(buf + len, '0', point - len);
+        buf += point;
+    } else if (0 < point && point <= 21) {
+        // 1234e-2 -> 12.34
+        memmove(buf + point + 1, buf + point, len - point);
+        buf[point] = '.';
+        buf += len + 1;
+    } else if (-6 < point && point <= 0) {
+        // 1234e-6 -> 0.001234
+        memmove(buf + 2 - point, buf, len);
+        buf[0] = '0';
+        buf[1] = '.';
+        memset(buf + 2, '0', -point);
+        buf += 2 - point + len;
+    } else {
+        // 1234e30 -> 1.234e+33
+        if (len > 1) {
+            memmove(buf + 2, buf + 1, len - 1);
+            buf[1] = '.';
+            buf += len + 1;
+        } else {
+            buf++;
+        }
+        *buf++ = 'e';
+        *buf++ = point > 0 ? '+' : '-';
+        buf += es_u64_to_buf(point > 0 ? point - 1 : 1 - point, buf);
+    }
 
-    return final;
+    *buf = '\0';
+    return buf - start;
 }
-es_str_t es_str_i32(i32_t value) { return es_str_i64(value); }
-es_str_t es_str_i16(i16_t value) { return es_str_i64(value); }
-es_str_t es_str_i8(i8_t value)   { return es_str_i64(value); }
 
-es_str_t es_str_b8(b8_t value) {
-    return es_str(value ? "true" : "false");
+// Read 8 digits as a number.
+ES_INLINE u64_t _es_parse_8_digits(u64_t chunk) {
+    chunk -= 0x3030303030303030ull;
+    chunk = (chunk * 10) + (chunk >> 8);
+    return (((chunk & 0x000000ff000000ffull) * (100 + (1000000ull << 32))) +
+            (((chunk >> 16) & 0x000000ff000000ffull) * (1 + (10000ull << 32)))) >> 32;
 }
 
-void es_str_free(es_str_t *str) {
-    es_free(_es_str_head(*str));
-    *str = NULL;
+// Load 8 characters with the first one in the lowest byte.
+ES_INLINE u64_t _es_load_8_chars(const char *str) {
+    const u8_t *p = (const u8_t *) str;
+    return (u64_t) p[0] | (u64_t) p[1] << 8 | (u64_t) p[2] << 16 | (u64_t) p[3] << 24 |
+           (u64_t) p[4] << 32 | (u64_t) p[5] << 40 | (u64_t) p[6] << 48 | (u64_t) p[7] << 56;
 }
 
-void es_str_free_list(es_da(es_str_t) *list) {
-    for (usize_t i = 0; i < es_da_count(*list); i++) {
-        es_str_free(&(*list)[i]);
-    }
-    es_da_free(*list);
+ES_INLINE b8_t _es_is_8_digits(u64_t chunk) {
+    return ((chunk & 0xf0f0f0f0f0f0f0f0ull) |
+            (((chunk + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) >> 4)) == 0x3333333333333333ull;
 }
 
-b8_t es_str_valid(const es_str_t str) {
-    if (str == NULL) {
-        return false;
+usize_t es_parse_u64(es_strview_t str, u64_t *value) {
+    u64_t result = 0;
+    usize_t i = 0;
+
+    // Two chunks of 8 digits can't overflow.
+    while (i + 8 <= str.len && i < 16) {
+        u64_t chunk = _es_load_8_chars(str.data + i);
+        if (!_es_is_8_digits(chunk)) {
+            break;
+        }
+        result = result * 100000000 + _es_parse_8_digits(chunk);
+        i += 8;
+    }
+    for (; i < str.len && es_is_digit(str.data[i]); i++) {
+        u64_t digit = str.data[i] - '0';
+        if (result > ((u64_t) -1 - digit) / 10) {
+            return 0;
+        }
+        result = result * 10 + digit;
     }
-    return _es_str_head(str)->valid;
-}
 
-usize_t es_str_len(const es_str_t str) {
-    return _es_str_head(str)->len;
+    if (i == 0) {
+        return 0;
+    }
+    *value = result;
+    return i;
 }
 
-void es_str_concat_len(es_str_t *str, const char *end, usize_t len) {
-    usize_t orig_len = es_str_len(*str);
-    _es_str_resize(str, len);
-    if (!es_str_valid(*str)) {
-        return;
+usize_t es_parse_i64(es_strview_t str, i64_t *value) {
+    usize_t i = 0;
+    b8_t negative = false;
+    if (str.len > 0 && (str.data[0] == '-' || str.data[0] == '+')) {
+        negative = str.data[0] == '-';
+        i++;
     }
-    memcpy(*str + orig_len, end, len);
-    (*str)[orig_len + len] = '\0';
-}
 
-void es_str_concat(es_str_t *str, const char *end) {
-    es_str_concat_len(str, end, es_cstr_len(end));
+    u64_t magnitude;
+    usize_t len = es_parse_u64(es_strview_skip(str, i), &magnitude);
+    if (len == 0 || magnitude > (1ull << 63) - !negative) {
+        return 0;
+    }
+    // Negating as unsigned keeps the smallest value from overflowing.
+    *value = negative ? (i64_t) (0 - magnitude) : (i64_t) magnitude;
+    return i + len;
 }
 
-void es_str_concat_char(es_str_t *str, char c) {
-    _es_str_resize(str, 1);
-    if (!es_str_valid(*str)) {
-        return;
+// Powers of ten which are exact as doubles.
+static const f64_t _es_exact_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// Match a case insensitive word at the start of str. Returns its length or 0.
+ES_INLINE usize_t _es_parse_word(es_strview_t str, const char *word) {
+    usize_t i = 0;
+    for (; word[i] != '\0'; i++) {
+        if (i >= str.len || (str.data[i] | 0x20) != word[i]) {
+            return 0;
+        }
     }
-    (*str)[es_str_len(*str) - 1] = c;
+    return i;
 }
 
-void es_str_reverse(es_str_t *str) {
-    usize_t start = 0, end = es_str_len(*str) - 1;
-    while (start < end) {
-        char temp = (*str)[start];
-        (*str)[start] = (*str)[end];
-        (*str)[end] = temp;
+// Upper 128 bits of 5^q for q from -342 to 308, rounded up for negative q.
+// Shifted so the highest bit is set.
+static const struct {
+    u64_t hi;
+    u64_t lo;
+} _es_pow5_128[] = {
+    { 0xeef453d6923bd65aull, 0x113faa2906a13b3full },
+    { 0x9558b4661b6565f8ull, 0x4ac7ca59a424c507ull },
+    { 0xbaaee17fa23ebf76ull, 0x5d79bcf00d2df649ull },
+    { 0xe95a99df8ace6f53ull, 0xf4d82c2c107973dcull },
+    { 0x91d8a02bb6c10594ull, 0x79071b9b8a4be869ull },
+    { 0xb64ec836a47146f9ull, 0x9748e2826cdee284ull },
+    { 0xe3e27a444d8d98b7ull, 0xfd1b1b2308169b25ull },
+    { 0x8e6d8c6ab0787f72ull, 0xfe30f0f5e50e20f7ull },
+    { 0xb208ef855c969f4full, 0xbdbd2d335e51a935ull },
+    { 0xde8b2b66b3bc4723ull, 0xad2c788035e61382ull },
+    { 0x8b16fb203055ac76ull, 0x4c3bcb5021afcc31ull },
+    { 0xaddcb9e83c6b1793ull, 0xdf4abe242a1bbf3dull },
+    { 0xd953e8624b85dd78ull, 0xd71d6dad34a2af0dull },
+    { 0x87d4713d6f33aa6bull, 0x8672648c40e5ad68ull },
+    { 0xa9c98d8ccb009506ull, 0x680efdaf511f18c2ull },
+    { 0xd43bf0effdc0ba48ull, 0x0212bd1b2566def2ull },
+    { 0x84a57695fe98746dull, 0x014bb630f7604b57ull },
+    { 0xa5ced43b7e3e9188ull, 0x419ea3bd35385e2dull },
+    { 0xcf42894a5dce35eaull, 0x52064cac828675b9ull },
+    { 0x818995ce7aa0e1b2ull, 0x7343efebd1940993ull },
+    { 0xa1ebfb4219491a1full, 0x1014ebe6c5f90bf8ull },
+    { 0xca66fa129f9b60a6ull, 0xd41a26e077774ef6ull },
+    { 0xfd00b897478238d0ull, 0x8920b098955522b4ull },
+    { 0x9e20735e8cb16382ull, 0x55b46e5f5d5535b0ull },
+    { 0xc5a890362fddbc62ull, 0xeb2189f734aa831dull },
+    { 0xf712b443bbd52b7bull, 0xa5e9ec7501d523e4ull },
+    { 0x9a6bb0aa55653b2dull, 0x47b233c92125366eull },
+    { 0xc1069cd4eabe89f8ull, 0x999ec0bb696e840aull },
+    { 0xf148440a256e2c76ull, 0xc00670ea43ca250dull },
+    { 0x96cd2a865764dbcaull, 0x380406926a5e5728ull },
+    { 0xbc807527ed3e12bcull, 0xc605083704f5ecf2ull },
+    { 0xeba09271e88d976bull, 0xf7864a44c633682eull },
+    { 0x93445b8731587ea3ull, 0x7ab3ee6afbe0211dull },
+    { 0xb8157268fdae9e4cull, 0x5960ea05bad82964ull },
+    { 0xe61acf033d1a45dfull, 0x6fb92487298e33bdull },
+    { 0x8fd0c16206306babull, 0xa5d3b6d479f8e056ull },
+    { 0xb3c4f1ba87bc8696ull, 0x8f48a4899877186cull },
+    { 0xe0b62e2929aba83cull, 0x331acdabfe94de87ull },
+    { 0x8c71dcd9ba0b4925ull, 0x9ff0c08b7f1d0b14ull },
+    { 0xaf8e5410288e1b6full, 0x07ecf0ae5ee44dd9ull },
+    { 0xdb71e91432b1a24aull, 0xc9e82cd9f69d6150ull },
+    { 0x892731ac9faf056eull, 0xbe311c083a225cd2ull },
+    { 0xab70fe17c79ac6caull, 0x6dbd630a48aaf406ull },
+    { 0xd64d3d9db981787dull, 0x092cbbccdad5b108ull },
+    { 0x85f0468293f0eb4eull, 0x25bbf56008c58ea5ull },
+    { 0xa76c582338ed2621ull, 0xaf2af2b80af6f24eull },
+    { 0xd1476e2c07286faaull, 0x1af5af660db4aee1ull },
+    { 0x82cca4db847945caull, 0x50d98d9fc890ed4dull },
+    { 0xa37fce126597973cull, 0xe50ff107bab528a0ull },
+    { 0xcc5fc196fefd7d0cull, 0x1e53ed49a96272c8ull },
+    { 0xff77b1fcbebcdc4full, 0x25e8e89c13bb0f7aull },
+    { 0x9faacf3df73609b1ull, 0x77b191618c54e9acull },
+    { 0xc795830d75038c1dull, 0xd59df5b9ef6a2417ull },
+    { 0xf97ae3d0d2446f25ull, 0x4b0573286b44ad1dull },
+    { 0x9becce62836ac577ull, 0x4ee367f9430aec32ull },
+    { 0xc2e801fb244576d5ull, 0x229c41f793cda73full },
+    { 0xf3a20279ed56d48aull, 0x6b43527578c1110full },
+    { 0x9845418c345644d6ull, 0x830a13896b78aaa9ull },
+    { 0xbe5691ef416bd60cull, 0x23cc986bc656d553ull },
+    { 0xedec366b11c6cb8full, 0x2cbfbe86b7ec8aa8ull },
+    { 0x94b3a202eb1c3f39ull, 0x7bf7d71432f3d6a9ull },
+    { 0xb9e08a83a5e34f07ull, 0xdaf5ccd93fb0cc53ull },
+    { 0xe858ad248f5c22c9ull, 0xd1b3400f8f9cff68ull },
+    { 0x91376c36d99995beull, 0x23100809b9c21fa1ull },
+    { 0xb58547448ffffb2dull, 0xabd40a0c2832a78aull },
+    { 0xe2e69915b3fff9f9ull, 0x16c90c8f323f516cull },
+    { 0x8dd01fad907ffc3bull, 0xae3da7d97f6792e3ull },
+    { 0xb1442798f49ffb4aull, 0x99cd11cfdf41779cull },
+    { 0xdd95317f31c7fa1dull, 0x40405643d711d583ull },
+    { 0x8a7d3eef7f1cfc52ull, 0x482835ea666b2572ull },
+    { 0xad1c8eab5ee43b66ull, 0xda3243650005eecfull },
+    { 0xd863b256369d4a40ull, 0x90bed43e40076a82ull },
+    { 0x873e4f75e2224e68ull, 0x5a7744a6e804a291ull },
+    { 0xa90de3535aaae202ull, 0x711515d0a205cb36ull },
+    { 0xd3515c2831559a83ull, 0x0d5a5b44ca873e03ull },
+    { 0x8412d9991ed58091ull, 0xe858790afe9486c2ull },
+    { 0xa5178fff668ae0b6ull, 0x626e974dbe39a872ull },
+    { 0xce5d73ff402d98e3ull, 0xfb0a3d212dc8128full },
+    { 0x80fa687f881c7f8eull, 0x7ce66634bc9d0b99ull },
+    { 0xa139029f6a239f72ull, 0x1c1fffc1ebc44e80ull },
+    { 0xc987434744ac874eull, 0xa327ffb266b56220ull },
+    { 0xfbe9141915d7a922ull, 0x4bf1ff9f0062baa8ull },
+    { 0x9d71ac8fada6c9b5ull, 0x6f773fc3603db4a9ull },
+    { 0xc4ce17b399107c22ull, 0xcb550fb4384d21d3ull },
+    { 0xf6019da07f549b2bull, 0x7e2a53a146606a48ull },
+    { 0x99c102844f94e0fbull, 0x2eda7444cbfc426dull },
+    { 0xc0314325637a1939ull, 0xfa911155fefb5308ull },
+    { 0xf03d93eebc589f88ull, 0x793555ab7eba27caull },
+    { 0x96267c7535b763b5ull, 0x4bc1558b2f3458deull },
+    { 0xbbb01b9283253ca2ull, 0x9eb1aaedfb016f16ull },
+    { 0xea9c227723ee8bcbull, 0x465e15a979c1cadcull },
+    { 0x92a1958a7675175full, 0x0bfacd89ec191ec9ull },
+    { 0xb749faed14125d36ull, 0xcef980ec671f667bull },
+    { 0xe51c79a85916f484ull, 0x82b7e12780e7401aull },
+    { 0x8f31cc0937ae58d2ull, 0xd1b2ecb8b0908810ull },
+    { 0xb2fe3f0b8599ef07ull, 0x861fa7e6dcb4aa15ull },
+    { 0xdfbdcece67006ac9ull, 0x67a791e093e1d49aull },
+    { 0x8bd6a141006042bdull, 0xe0c8bb2c5c6d24e0ull },
+    { 0xaecc49914078536dull, 0x58fae9f773886e18ull },
+    { 0xda7f5bf590966848ull, 0xaf39a475506a899eull },
+    { 0x888f99797a5e012dull, 0x6d8406c952429603ull },
+    { 0xaab37fd7d8f58178ull, 0xc8e5087ba6d33b83ull },
+    { 0xd5605fcdcf32e1d6ull, 0xfb1e4a9a90880a64ull },
+    { 0x855c3be0a17fcd26ull, 0x5cf2eea09a55067full },
+    { 0xa6b34ad8c9dfc06full, 0xf42faa48c0ea481eull },
+    { 0xd0601d8efc57b08bull, 0xf13b94daf124da26ull },
+    { 0x823c12795db6ce57ull, 0x76c53d08d6b70858ull },
+    { 0xa2cb1717b52481edull, 0x54768c4b0c64ca6eull },
+    { 0xcb7ddcdda26da268ull, 0xa9942f5dcf7dfd09ull },
+    { 0xfe5d54150b090b02ull, 0xd3f93b35435d7c4cull },
+    { 0x9efa548d26e5a6e1ull, 0xc47bc5014a1a6dafull },
+    { 0xc6b8e9b0709f109aull, 0x359ab6419ca1091bull },
+    { 0xf867241c8cc6d4c0ull, 0xc30163d203c94b62ull },
+    { 0x9b407691d7fc44f8ull, 0x79e0de63425dcf1dull },
+    { 0xc21094364dfb5636ull, 0x985915fc12f542e4ull },
+    { 0xf294b943e17a2bc4ull, 0x3e6f5b7b17b2939dull },
+    { 0x979cf3ca6cec5b5aull, 0xa705992ceecf9c42ull },
+    { 0xbd8430bd08277231ull, 0x50c6ff782a838353ull },
+    { 0xece53cec4a314ebdull, 0xa4f8bf5635246428ull },
+    { 0x940f4613ae5ed136ull, 0x871b7795e136be99ull },
+    { 0xb913179899f68584ull, 0x28e2557b59846e3full },
+    { 0xe757dd7ec07426e5ull, 0x331aeada2fe589cfull },
+    { 0x9096ea6f3848984full, 0x3ff0d2c85def7621ull },
+    { 0xb4bca50b065abe63ull, 0x0fed077a756b53a9ull },
+    { 0xe1ebce4dc7f16dfbull, 0xd3e8495912c62894ull },
+    { 0x8d3360f09cf6e4bdull, 0x64712dd7abbbd95cull },
+    { 0xb080392cc4349decull, 0xbd8d794d96aacfb3ull },
+    { 0xdca04777f541c567ull, 0xecf0d7a0fc5583a0ull },
+    { 0x89e42caaf9491b60ull, 0xf41686c49db57244ull },
+    { 0xac5d37d5b79b6239ull, 0x311c2875c522ced5ull },
+    { 0xd77485cb25823ac7ull, 0x7d633293366b828bull },
+    { 0x86a8d39ef77164bcull, 0xae5dff9c02033197ull },
+    { 0xa8530886b54dbdebull, 0xd9f57f830283fdfcull },
+    { 0xd267caa862a12d66ull, 0xd072df63c324fd7bull },
+    { 0x8380dea93da4bc60ull, 0x4247cb9e59f71e6dull },
+    { 0xa46116538d0deb78ull, 0x52d9be85f074e608ull },
+    { 0xcd795be870516656ull, 0x67902e276c921f8bull },
+    { 0x806bd9714632dff6ull, 0x00ba1cd8a3db53b6ull },
+    { 0xa086cfcd97bf97f3ull, 0x80e8a40eccd228a4ull },
+    { 0xc8a883c0fdaf7df0ull, 0x6122cd128006b2cdull },
+    { 0xfad2a4b13d1b5d6cull, 0x796b805720085f81ull },
+    { 0x9cc3a6eec6311a63ull, 0xcbe3303674053bb0ull },
+    { 0xc3f490aa77bd60fcull, 0xbedbfc4411068a9cull },
+    { 0xf4f1b4d515acb93bull, 0xee92fb5515482d44ull },
+    { 0x991711052d8bf3c5ull, 0x751bdd152d4d1c4aull },
+    { 0xbf5cd54678eef0b6ull, 0xd262d45a78a0635dull },
+    { 0xef340a98172aace4ull, 0x86fb897116c87c34ull },
+    { 0x9580869f0e7aac0eull, 0xd45d35e6ae3d4da0ull },
+    { 0xbae0a846d2195712ull, 0x8974836059cca109ull },
+    { 0xe998d258869facd7ull, 0x2bd1a438703fc94bull },
+    { 0x91ff83775423cc06ull, 0x7b6306a34627ddcfull },
+    { 0xb67f6455292cbf08ull, 0x1a3bc84c17b1d542ull },
+    { 0xe41f3d6a7377eecaull, 0x20caba5f1d9e4a93ull },
+    { 0x8e938662882af53eull, 0x547eb47b7282ee9cull },
+    { 0xb23867fb2a35b28dull, 0xe99e619a4f23aa43ull },
+    { 0xdec681f9f4c31f31ull, 0x6405fa00e2ec94d4ull },
+    { 0x8b3c113c38f9f37eull, 0xde83bc408dd3dd04ull },
+    { 0xae0b158b4738705eull, 0x9624ab50b148d445ull },
+    { 0xd98ddaee19068c76ull, 0x3badd624dd9b0957ull },
+    { 0x87f8a8d4cfa417c9ull, 0xe54ca5d70a80e5d6ull },
+    { 0xa9f6d30a038d1dbcull, 0x5e9fcf4ccd211f4cull },
+    { 0xd47487cc8470652bull, 0x7647c3200069671full },
+    { 0x84c8d4dfd2c63f3bull, 0x29ecd9f40041e073ull },
+    { 0xa5fb0a17c777cf09ull, 0xf468107100525890ull },
+    { 0xcf79cc9db955c2ccull, 0x7182148d4066eeb4ull },
+    { 0x81ac1fe293d599bfull, 0xc6f14cd848405530ull },
+    { 0xa21727db38cb002full, 0xb8ada00e5a506a7cull },
+    { 0xca9cf1d206fdc03bull, 0xa6d90811f0e4851cull },
+    { 0xfd442e4688bd304aull, 0x908f4a166d1da663ull },
+    { 0x9e4a9cec15763e2eull, 0x9a598e4e043287feull },
+    { 0xc5dd44271ad3cdbaull, 0x40eff1e1853f29fdull },
+    { 0xf7549530e188c128ull, 0xd12bee59e68ef47cull },
+    { 0x9a94dd3e8cf578b9ull, 0x82bb74f8301958ceull },
+    { 0xc13a148e3032d6e7ull, 0xe36a52363c1faf01ull },
+    { 0xf18899b1bc3f8ca1ull, 0xdc44e6c3cb279ac1ull },
+    { 0x96f5600f15a7b7e5ull, 0x29ab103a5ef8c0b9ull },
+    { 0xbcb2b812db11a5deull, 0x7415d448f6b6f0e7ull },
+    { 0xebdf661791d60f56ull, 0x111b495b3464ad21ull },
+    { 0x936b9fcebb25c995ull, 0xcab10dd900beec34ull },
+    { 0xb84687c269ef3bfbull, 0x3d5d514f40eea742ull },
+    { 0xe65829b3046b0afaull, 0x0cb4a5a3112a5112ull },
+    { 0x8ff71a0fe2c2e6dcull, 0x47f0e785eaba72abull },
+    { 0xb3f4e093db73a093ull, 0x59ed216765690f56ull },
+    { 0xe0f218b8d25088b8ull, 0x306869c13ec3532cull },
+    { 0x8c974f7383725573ull, 0x1e414218c73a13fbull },
+    { 0xafbd2350644eeacfull, 0xe5d1929ef90898faull },
+    { 0xdbac6c247d62a583ull, 0xdf45f746b74abf39ull },
+    { 0x894bc396ce5da772ull, 0x6b8bba8c328eb783ull },
+    { 0xab9eb47c81f5114full, 0x066ea92f3f326564ull },
+    { 0xd686619ba27255a2ull, 0xc80a537b0efefebdull },
+    { 0x8613fd0145877585ull, 0xbd06742ce95f5f36ull },
+    { 0xa798fc4196e952e7ull, 0x2c48113823b73704ull },
+    { 0xd17f3b51fca3a7a0ull, 0xf75a15862ca504c5ull },
+    { 0x82ef85133de648c4ull, 0x9a984d73dbe722fbull },
+    { 0xa3ab66580d5fdaf5ull, 0xc13e60d0d2e0ebbaull },
+    { 0xcc963fee10b7d1b3ull, 0x318df905079926a8ull },
+    { 0xffbbcfe994e5c61full, 0xfdf17746497f7052ull },
+    { 0x9fd561f1fd0f9bd3ull, 0xfeb6ea8bedefa633ull },
+    { 0xc7caba6e7c5382c8ull, 0xfe64a52ee96b8fc0ull },
+    { 0xf9bd690a1b68637bull, 0x3dfdce7aa3c673b0ull },
+    { 0x9c1661a651213e2dull, 0x06bea10ca65c084eull },
+    { 0xc31bfa0fe5698db8ull, 0x486e494fcff30a62ull },
+    { 0xf3e2f893dec3f126ull, 0x5a89dba3c3efccfaull },
+    { 0x986ddb5c6b3a76b7ull, 0xf89629465a75e01cull },
+    { 0xbe89523386091465ull, 0xf6bbb397f1135823ull },
+    { 0xee2ba6c0678b597full, 0x746aa07ded582e2cull },
+    { 0x94db483840b717efull, 0xa8c2a44eb4571cdcull },
+    { 0xba121a4650e4ddebull, 0x92f34d62616ce413ull },
+    { 0xe896a0d7e51e1566ull, 0x77b020baf9c81d17ull },
+    { 0x915e2486ef32cd60ull, 0x0ace1474dc1d122eull },
+    { 0xb5b5ada8aaff80b8ull, 0x0d819992132456baull },
+    { 0xe3231912d5bf60e6ull, 0x10e1fff697ed6c69ull },
+    { 0x8df5efabc5979c8full, 0xca8d3ffa1ef463c1ull },
+    { 0xb1736b96b6fd83b3ull, 0xbd308ff8a6b17cb2ull },
+    { 0xddd0467c64bce4a0ull, 0xac7cb3f6d05ddbdeull },
+    { 0x8aa22c0dbef60ee4ull, 0x6bcdf07a423aa96bull },
+    { 0xad4ab7112eb3929dull, 0x86c16c98d2c953c6ull },
+    { 0xd89d64d57a607744ull, 0xe871c7bf077ba8b7ull },
+    { 0x87625f056c7c4a8bull, 0x11471cd764ad4972ull },
+    { 0xa93af6c6c79b5d2dull, 0xd598e40d3dd89bcfull },
+    { 0xd389b47879823479ull, 0x4aff1d108d4ec2c3ull },
+    { 0x843610cb4bf160cbull, 0xcedf722a585139baull },
+    { 0xa54394fe1eedb8feull, 0xc2974eb4ee658828ull },
+    { 0xce947a3da6a9273eull, 0x733d226229feea32ull },
+    { 0x811ccc668829b887ull, 0x0806357d5a3f525full },
+    { 0xa163ff802a3426a8ull, 0xca07c2dcb0cf26f7ull },
+    { 0xc9bcff6034c13052ull, 0xfc89b393dd02f0b5ull },
+    { 0xfc2c3f3841f17c67ull, 0xbbac2078d443ace2ull },
+    { 0x9d9ba7832936edc0ull, 0xd54b944b84aa4c0dull },
+    { 0xc5029163f384a931ull, 0x0a9e795e65d4df11ull },
+    { 0xf64335bcf065d37dull, 0x4d4617b5ff4a16d5ull },
+    { 0x99ea0196163fa42eull, 0x504bced1bf8e4e45ull },
+    { 0xc06481fb9bcf8d39ull, 0xe45ec2862f71e1d6ull },
+    { 0xf07da27a82c37088ull, 0x5d767327bb4e5a4cull },
+    { 0x964e858c91ba2655ull, 0x3a6a07f8d510f86full },
+    { 0xbbe226efb628afeaull, 0x890489f70a55368bull },
+    { 0xeadab0aba3b2dbe5ull, 0x2b45ac74ccea842eull },
+    { 0x92c8ae6b464fc96full, 0x3b0b8bc90012929dull },
+    { 0xb77ada0617e3bbcbull, 0x09ce6ebb40173744ull },
+    { 0xe55990879ddcaabdull, 0xcc420a6a101d0515ull },
+    { 0x8f57fa54c2a9eab6ull, 0x9fa946824a12232dull },
+    { 0xb32df8e9f3546564ull, 0x47939822dc96abf9ull },
+    { 0xdff9772470297ebdull, 0x59787e2b93bc56f7ull },
+    { 0x8bfbea76c619ef36ull, 0x57eb4edb3c55b65aull },
+    { 0xaefae51477a06b03ull, 0xede622920b6b23f1ull },
+    { 0xdab99e59958885c4ull, 0xe95fab368e45ecedull },
+    { 0x88b402f7fd75539bull, 0x11dbcb0218ebb414ull },
+    { 0xaae103b5fcd2a881ull, 0xd652bdc29f26a119ull },
+    { 0xd59944a37c0752a2ull, 0x4be76d3346f0495full },
+    { 0x857fcae62d8493a5ull, 0x6f70a4400c562ddbull },
+    { 0xa6dfbd9fb8e5b88eull, 0xcb4ccd500f6bb952ull },
+    { 0xd097ad07a71f26b2ull, 0x7e2000a41346a7a7ull },
+    { 0x825ecc24c873782full, 0x8ed400668c0c28c8ull },
+    { 0xa2f67f2dfa90563bull, 0x728900802f0f32faull },
+    { 0xcbb41ef979346bcaull, 0x4f2b40a03ad2ffb9ull },
+    { 0xfea126b7d78186bcull, 0xe2f610c84987bfa8ull },
+    { 0x9f24b832e6b0f436ull, 0x0dd9ca7d2df4d7c9ull },
+    { 0xc6ede63fa05d3143ull, 0x91503d1c79720dbbull },
+    { 0xf8a95fcf88747d94ull, 0x75a44c6397ce912aull },
+    { 0x9b69dbe1b548ce7cull, 0xc986afbe3ee11abaull },
+    { 0xc24452da229b021bull, 0xfbe85badce996168ull },
+    { 0xf2d56790ab41c2a2ull, 0xfae27299423fb9c3ull },
+    { 0x97c560ba6b0919a5ull, 0xdccd879fc967d41aull },
+    { 0xbdb6b8e905cb600full, 0x5400e987bbc1c920ull },
+    { 0xed246723473e3813ull, 0x290123e9aab23b68ull },
+    { 0x9436c0760c86e30bull, 0xf9a0b6720aaf6521ull },
+    { 0xb94470938fa89bceull, 0xf808e40e8d5b3e69ull },
+    { 0xe7958cb87392c2c2ull, 0xb60b1d1230b20e04ull },
+    { 0x90bd77f3483bb9b9ull, 0xb1c6f22b5e6f48c2ull },
+    { 0xb4ecd5f01a4aa828ull, 0x1e38aeb6360b1af3ull },
+    { 0xe2280b6c20dd5232ull, 0x25c6da63c38de1b0ull },
+    { 0x8d590723948a535full, 0x579c487e5a38ad0eull },
+    { 0xb0af48ec79ace837ull, 0x2d835a9df0c6d851ull },
+    { 0xdcdb1b2798182244ull, 0xf8e431456cf88e65ull },
+    { 0x8a08f0f8bf0f156bull, 0x1b8e9ecb641b58ffull },
+    { 0xac8b2d36eed2dac5ull, 0xe272467e3d222f3full },
+    { 0xd7adf884aa879177ull, 0x5b0ed81dcc6abb0full },
+    { 0x86ccbb52ea94baeaull, 0x98e947129fc2b4e9ull },
+    { 0xa87fea27a539e9a5ull, 0x3f2398d747b36224ull },
+    { 0xd29fe4b18e88640eull, 0x8eec7f0d19a03aadull },
+    { 0x83a3eeeef9153e89ull, 0x1953cf68300424acull },
+    { 0xa48ceaaab75a8e2bull, 0x5fa8c3423c052dd7ull },
+    { 0xcdb02555653131b6ull, 0x3792f412cb06794dull },
+    { 0x808e17555f3ebf11ull, 0xe2bbd88bbee40bd0ull },
+    { 0xa0b19d2ab70e6ed6ull, 0x5b6aceaeae9d0ec4ull },
+    { 0xc8de047564d20a8bull, 0xf245825a5a445275ull },
+    { 0xfb158592be068d2eull, 0xeed6e2f0f0d56712ull },
+    { 0x9ced737bb6c4183dull, 0x55464dd69685606bull },
+    { 0xc428d05aa4751e4cull, 0xaa97e14c3c26b886ull },
+    { 0xf53304714d9265dfull, 0xd53dd99f4b3066a8ull },
+    { 0x993fe2c6d07b7fabull, 0xe546a8038efe4029ull },
+    { 0xbf8fdb78849a5f96ull, 0xde98520472bdd033ull },
+    { 0xef73d256a5c0f77cull, 0x963e66858f6d4440ull },
+    { 0x95a8637627989aadull, 0xdde7001379a44aa8ull },
+    { 0xbb127c53b17ec159ull, 0x5560c018580d5d52ull },
+    { 0xe9d71b689dde71afull, 0xaab8f01e6e10b4a6ull },
+    { 0x9226712162ab070dull, 0xcab3961304ca70e8ull },
+    { 0xb6b00d69bb55c8d1ull, 0x3d607b97c5fd0d22ull },
+    { 0xe45c10c42a2b3b05ull, 0x8cb89a7db77c506aull },
+    { 0x8eb98a7a9a5b04e3ull, 0x77f3608e92adb242ull },
+    { 0xb267ed1940f1c61cull, 0x55f038b237591ed3ull },
+    { 0xdf01e85f912e37a3ull, 0x6b6c46dec52f6688ull },
+    { 0x8b61313bbabce2c6ull, 0x2323ac4b3b3da015ull },
+    { 0xae397d8aa96c1b77ull, 0xabec975e0a0d081aull },
+    { 0xd9c7dced53c72255ull, 0x96e7bd358c904a21ull },
+    { 0x881cea14545c7575ull, 0x7e50d64177da2e54ull },
+    { 0xaa242499697392d2ull, 0xdde50bd1d5d0b9e9ull },
+    { 0xd4ad2dbfc3d07787ull, 0x955e4ec64b44e864ull },
+    { 0x84ec3c97da624ab4ull, 0xbd5af13bef0b113eull },
+    { 0xa6274bbdd0fadd61ull, 0xecb1ad8aeacdd58eull },
+    { 0xcfb11ead453994baull, 0x67de18eda5814af2ull },
+    { 0x81ceb32c4b43fcf4ull, 0x80eacf948770ced7ull },
+    { 0xa2425ff75e14fc31ull, 0xa1258379a94d028dull },
+    { 0xcad2f7f5359a3b3eull, 0x096ee45813a04330ull },
+    { 0xfd87b5f28300ca0dull, 0x8bca9d6e188853fcull },
+    { 0x9e74d1b791e07e48ull, 0x775ea264cf55347eull },
+    { 0xc612062576589ddaull, 0x95364afe032a819eull },
+    { 0xf79687aed3eec551ull, 0x3a83ddbd83f52205ull },
+    { 0x9abe14cd44753b52ull, 0xc4926a9672793543ull },
+    { 0xc16d9a0095928a27ull, 0x75b7053c0f178294ull },
+    { 0xf1c90080baf72cb1ull, 0x5324c68b12dd6339ull },
+    { 0x971da05074da7beeull, 0xd3f6fc16ebca5e04ull },
+    { 0xbce5086492111aeaull, 0x88f4bb1ca6bcf585ull },
+    { 0xec1e4a7db69561a5ull, 0x2b31e9e3d06c32e6ull },
+    { 0x9392ee8e921d5d07ull, 0x3aff322e62439fd0ull },
+    { 0xb877aa3236a4b449ull, 0x09befeb9fad487c3ull },
+    { 0xe69594bec44de15bull, 0x4c2ebe687989a9b4ull },
+    { 0x901d7cf73ab0acd9ull, 0x0f9d37014bf60a11ull },
+    { 0xb424dc35095cd80full, 0x538484c19ef38c95ull },
+    { 0xe12e13424bb40e13ull, 0x2865a5f206b06fbaull },
+    { 0x8cbccc096f5088cbull, 0xf93f87b7442e45d4ull },
+    { 0xafebff0bcb24aafeull, 0xf78f69a51539d749ull },
+    { 0xdbe6fecebdedd5beull, 0xb573440e5a884d1cull },
+    { 0x89705f4136b4a597ull, 0x31680a88f8953031ull },
+    { 0xabcc77118461cefcull, 0xfdc20d2b36ba7c3eull },
+    { 0xd6bf94d5e57a42bcull, 0x3d32907604691b4dull },
+    { 0x8637bd05af6c69b5ull, 0xa63f9a49c2c1b110ull },
+    { 0xa7c5ac471b478423ull, 0x0fcf80dc33721d54ull },
+    { 0xd1b71758e219652bull, 0xd3c36113404ea4a9ull },
+    { 0x83126e978d4fdf3bull, 0x645a1cac083126eaull },
+    { 0xa3d70a3d70a3d70aull, 0x3d70a3d70a3d70a4ull },
+    { 0xccccccccccccccccull, 0xcccccccccccccccdull },
+    { 0x8000000000000000ull, 0x0000000000000000ull },
+    { 0xa000000000000000ull, 0x0000000000000000ull },
+    { 0xc800000000000000ull, 0x0000000000000000ull },
+    { 0xfa00000000000000ull, 0x0000000000000000ull },
+    { 0x9c40000000000000ull, 0x0000000000000000ull },
+    { 0xc350000000000000ull, 0x0000000000000000ull },
+    { 0xf424000000000000ull, 0x0000000000000000ull },
+    { 0x9896800000000000ull, 0x0000000000000000ull },
+    { 0xbebc200000000000ull, 0x0000000000000000ull },
+    { 0xee6b280000000000ull, 0x0000000000000000ull },
+    { 0x9502f90000000000ull, 0x0000000000000000ull },
+    { 0xba43b74000000000ull, 0x0000000000000000ull },
+    { 0xe8d4a51000000000ull, 0x0000000000000000ull },
+    { 0x9184e72a00000000ull, 0x0000000000000000ull },
+    { 0xb5e620f480000000ull, 0x0000000000000000ull },
+    { 0xe35fa931a0000000ull, 0x0000000000000000ull },
+    { 0x8e1bc9bf04000000ull, 0x0000000000000000ull },
+    { 0xb1a2bc2ec5000000ull, 0x0000000000000000ull },
+    { 0xde0b6b3a76400000ull, 0x0000000000000000ull },
+    { 0x8ac7230489e80000ull, 0x0000000000000000ull },
+    { 0xad78ebc5ac620000ull, 0x0000000000000000ull },
+    { 0xd8d726b7177a8000ull, 0x0000000000000000ull },
+    { 0x878678326eac9000ull, 0x0000000000000000ull },
+    { 0xa968163f0a57b400ull, 0x0000000000000000ull },
+    { 0xd3c21bcecceda100ull, 0x0000000000000000ull },
+    { 0x84595161401484a0ull, 0x0000000000000000ull },
+    { 0xa56fa5b99019a5c8ull, 0x0000000000000000ull },
+    { 0xcecb8f27f4200f3aull, 0x0000000000000000ull },
+    { 0x813f3978f8940984ull, 0x4000000000000000ull },
+    { 0xa18f07d736b90be5ull, 0x5000000000000000ull },
+    { 0xc9f2c9cd04674edeull, 0xa400000000000000ull },
+    { 0xfc6f7c4045812296ull, 0x4d00000000000000ull },
+    { 0x9dc5ada82b70b59dull, 0xf020000000000000ull },
+    { 0xc5371912364ce305ull, 0x6c28000000000000ull },
+    { 0xf684df56c3e01bc6ull, 0xc732000000000000ull },
+    { 0x9a130b963a6c115cull, 0x3c7f400000000000ull },
+    { 0xc097ce7bc90715b3ull, 0x4b9f100000000000ull },
+    { 0xf0bdc21abb48db20ull, 0x1e86d40000000000ull },
+    { 0x96769950b50d88f4ull, 0x1314448000000000ull },
+    { 0xbc143fa4e250eb31ull, 0x17d955a000000000ull },
+    { 0xeb194f8e1ae525fdull, 0x5dcfab0800000000ull },
+    { 0x92efd1b8d0cf37beull, 0x5aa1cae500000000ull },
+    { 0xb7abc627050305adull, 0xf14a3d9e40000000ull },
+    { 0xe596b7b0c643c719ull, 0x6d9ccd05d0000000ull },
+    { 0x8f7e32ce7bea5c6full, 0xe4820023a2000000ull },
+    { 0xb35dbf821ae4f38bull, 0xdda2802c8a800000ull },
+    { 0xe0352f62a19e306eull, 0xd50b2037ad200000ull },
+    { 0x8c213d9da502de45ull, 0x4526f422cc340000ull },
+    { 0xaf298d050e4395d6ull, 0x9670b12b7f410000ull },
+    { 0xdaf3f04651d47b4cull, 0x3c0cdd765f114000ull },
+    { 0x88d8762bf324cd0full, 0xa5880a69fb6ac800ull },
+    { 0xab0e93b6efee0053ull, 0x8eea0d047a457a00ull },
+    { 0xd5d238a4abe98068ull, 0x72a4904598d6d880ull },
+    { 0x85a36366eb71f041ull, 0x47a6da2b7f864750ull },
+    { 0xa70c3c40a64e6c51ull, 0x999090b65f67d924ull },
+    { 0xd0cf4b50cfe20765ull, 0xfff4b4e3f741cf6dull },
+    { 0x82818f1281ed449full, 0xbff8f10e7a8921a4ull },
+    { 0xa321f2d7226895c7ull, 0xaff72d52192b6a0dull },
+    { 0xcbea6f8ceb02bb39ull, 0x9bf4f8a69f764490ull },
+    { 0xfee50b7025c36a08ull, 0x02f236d04753d5b4ull },
+    { 0x9f4f2726179a2245ull, 0x01d762422c946590ull },
+    { 0xc722f0ef9d80aad6ull, 0x424d3ad2b7b97ef5ull },
+    { 0xf8ebad2b84e0d58bull, 0xd2e0898765a7deb2ull },
+    { 0x9b934c3b330c8577ull, 0x63cc55f49f88eb2full },
+    { 0xc2781f49ffcfa6d5ull, 0x3cbf6b71c76b25fbull },
+    { 0xf316271c7fc3908aull, 0x8bef464e3945ef7aull },
+    { 0x97edd871cfda3a56ull, 0x97758bf0e3cbb5acull },
+    { 0xbde94e8e43d0c8ecull, 0x3d52eeed1cbea317ull },
+    { 0xed63a231d4c4fb27ull, 0x4ca7aaa863ee4bddull },
+    { 0x945e455f24fb1cf8ull, 0x8fe8caa93e74ef6aull },
+    { 0xb975d6b6ee39e436ull, 0xb3e2fd538e122b44ull },
+    { 0xe7d34c64a9c85d44ull, 0x60dbbca87196b616ull },
+    { 0x90e40fbeea1d3a4aull, 0xbc8955e946fe31cdull },
+    { 0xb51d13aea4a488ddull, 0x6babab6398bdbe41ull },
+    { 0xe264589a4dcdab14ull, 0xc696963c7eed2dd1ull },
+    { 0x8d7eb76070a08aecull, 0xfc1e1de5cf543ca2ull },
+    { 0xb0de65388cc8ada8ull, 0x3b25a55f43294bcbull },
+    { 0xdd15fe86affad912ull, 0x49ef0eb713f39ebeull },
+    { 0x8a2dbf142dfcc7abull, 0x6e3569326c784337ull },
+    { 0xacb92ed9397bf996ull, 0x49c2c37f07965404ull },
+    { 0xd7e77a8f87daf7fbull, 0xdc33745ec97be906ull },
+    { 0x86f0ac99b4e8dafdull, 0x69a028bb3ded71a3ull },
+    { 0xa8acd7c0222311bcull, 0xc40832ea0d68ce0cull },
+    { 0xd2d80db02aabd62bull, 0xf50a3fa490c30190ull },
+    { 0x83c7088e1aab65dbull, 0x792667c6da79e0faull },
+    { 0xa4b8cab1a1563f52ull, 0x577001b891185938ull },
+    { 0xcde6fd5e09abcf26ull, 0xed4c0226b55e6f86ull },
+    { 0x80b05e5ac60b6178ull, 0x544f8158315b05b4ull },
+    { 0xa0dc75f1778e39d6ull, 0x696361ae3db1c721ull },
+    { 0xc913936dd571c84cull, 0x03bc3a19cd1e38e9ull },
+    { 0xfb5878494ace3a5full, 0x04ab48a04065c723ull },
+    { 0x9d174b2dcec0e47bull, 0x62eb0d64283f9c76ull },
+    { 0xc45d1df942711d9aull, 0x3ba5d0bd324f8394ull },
+    { 0xf5746577930d6500ull, 0xca8f44ec7ee36479ull },
+    { 0x9968bf6abbe85f20ull, 0x7e998b13cf4e1ecbull },
+    { 0xbfc2ef456ae276e8ull, 0x9e3fedd8c321a67eull },
+    { 0xefb3ab16c59b14a2ull, 0xc5cfe94ef3ea101eull },
+    { 0x95d04aee3b80ece5ull, 0xbba1f1d158724a12ull },
+    { 0xbb445da9ca61281full, 0x2a8a6e45ae8edc97ull },
+    { 0xea1575143cf97226ull, 0xf52d09d71a3293bdull },
+    { 0x924d692ca61be758ull, 0x593c2626705f9c56ull },
+    { 0xb6e0c377cfa2e12eull, 0x6f8b2fb00c77836cull },
+    { 0xe498f455c38b997aull, 0x0b6dfb9c0f956447ull },
+    { 0x8edf98b59a373fecull, 0x4724bd4189bd5eacull },
+    { 0xb2977ee300c50fe7ull, 0x58edec91ec2cb657ull },
+    { 0xdf3d5e9bc0f653e1ull, 0x2f2967b66737e3edull },
+    { 0x8b865b215899f46cull, 0xbd79e0d20082ee74ull },
+    { 0xae67f1e9aec07187ull, 0xecd8590680a3aa11ull },
+    { 0xda01ee641a708de9ull, 0xe80e6f4820cc9495ull },
+    { 0x884134fe908658b2ull, 0x3109058d147fdcddull },
+    { 0xaa51823e34a7eedeull, 0xbd4b46f0599fd415ull },
+    { 0xd4e5e2cdc1d1ea96ull, 0x6c9e18ac7007c91aull },
+    { 0x850fadc09923329eull, 0x03e2cf6bc604ddb0ull },
+    { 0xa6539930bf6bff45ull, 0x84db8346b786151cull },
+    { 0xcfe87f7cef46ff16ull, 0xe612641865679a63ull },
+    { 0x81f14fae158c5f6eull, 0x4fcb7e8f3f60c07eull },
+    { 0xa26da3999aef7749ull, 0xe3be5e330f38f09dull },
+    { 0xcb090c8001ab551cull, 0x5cadf5bfd3072cc5ull },
+    { 0xfdcb4fa002162a63ull, 0x73d9732fc7c8f7f6ull },
+    { 0x9e9f11c4014dda7eull, 0x2867e7fddcdd9afaull },
+    { 0xc646d63501a1511dull, 0xb281e1fd541501b8ull },
+    { 0xf7d88bc24209a565ull, 0x1f225a7ca91a4226ull },
+    { 0x9ae757596946075full, 0x3375788de9b06958ull },
+    { 0xc1a12d2fc3978937ull, 0x0052d6b1641c83aeull },
+    { 0xf209787bb47d6b84ull, 0xc0678c5dbd23a49aull },
+    { 0x9745eb4d50ce6332ull, 0xf840b7ba963646e0ull },
+    { 0xbd176620a501fbffull, 0xb650e5a93bc3d898ull },
+    { 0xec5d3fa8ce427affull, 0xa3e51f138ab4cebeull },
+    { 0x93ba47c980e98cdfull, 0xc66f336c36b10137ull },
+    { 0xb8a8d9bbe123f017ull, 0xb80b0047445d4184ull },
+    { 0xe6d3102ad96cec1dull, 0xa60dc059157491e5ull },
+    { 0x9043ea1ac7e41392ull, 0x87c89837ad68db2full },
+    { 0xb454e4a179dd1877ull, 0x29babe4598c311fbull },
+    { 0xe16a1dc9d8545e94ull, 0xf4296dd6fef3d67aull },
+    { 0x8ce2529e2734bb1dull, 0x1899e4a65f58660cull },
+    { 0xb01ae745b101e9e4ull, 0x5ec05dcff72e7f8full },
+    { 0xdc21a1171d42645dull, 0x76707543f4fa1f73ull },
+    { 0x899504ae72497ebaull, 0x6a06494a791c53a8ull },
+    { 0xabfa45da0edbde69ull, 0x0487db9d17636892ull },
+    { 0xd6f8d7509292d603ull, 0x45a9d2845d3c42b6ull },
+    { 0x865b86925b9bc5c2ull, 0x0b8a2392ba45a9b2ull },
+    { 0xa7f26836f282b732ull, 0x8e6cac7768d7141eull },
+    { 0xd1ef0244af2364ffull, 0x3207d795430cd926ull },
+    { 0x8335616aed761f1full, 0x7f44e6bd49e807b8ull },
+    { 0xa402b9c5a8d3a6e7ull, 0x5f16206c9c6209a6ull },
+    { 0xcd036837130890a1ull, 0x36dba887c37a8c0full },
+    { 0x802221226be55a64ull, 0xc2494954da2c9789ull },
+    { 0xa02aa96b06deb0fdull, 0xf2db9baa10b7bd6cull },
+    { 0xc83553c5c8965d3dull, 0x6f92829494e5acc7ull },
+    { 0xfa42a8b73abbf48cull, 0xcb772339ba1f17f9ull },
+    { 0x9c69a97284b578d7ull, 0xff2a760414536efbull },
+    { 0xc38413cf25e2d70dull, 0xfef5138519684abaull },
+    { 0xf46518c2ef5b8cd1ull, 0x7eb258665fc25d69ull },
+    { 0x98bf2f79d5993802ull, 0xef2f773ffbd97a61ull },
+    { 0xbeeefb584aff8603ull, 0xaafb550ffacfd8faull },
+    { 0xeeaaba2e5dbf6784ull, 0x95ba2a53f983cf38ull },
+    { 0x952ab45cfa97a0b2ull, 0xdd945a747bf26183ull },
+    { 0xba756174393d88dfull, 0x94f971119aeef9e4ull },
+    { 0xe912b9d1478ceb17ull, 0x7a37cd5601aab85dull },
+    { 0x91abb422ccb812eeull, 0xac62e055c10ab33aull },
+    { 0xb616a12b7fe617aaull, 0x577b986b314d6009ull },
+    { 0xe39c49765fdf9d94ull, 0xed5a7e85fda0b80bull },
+    { 0x8e41ade9fbebc27dull, 0x14588f13be847307ull },
+    { 0xb1d219647ae6b31cull, 0x596eb2d8ae258fc8ull },
+    { 0xde469fbd99a05fe3ull, 0x6fca5f8ed9aef3bbull },
+    { 0x8aec23d680043beeull, 0x25de7bb9480d5854ull },
+    { 0xada72ccc20054ae9ull, 0xaf561aa79a10ae6aull },
+    { 0xd910f7ff28069da4ull, 0x1b2ba1518094da04ull },
+    { 0x87aa9aff79042286ull, 0x90fb44d2f05d0842ull },
+    { 0xa99541bf57452b28ull, 0x353a1607ac744a53ull },
+    { 0xd3fa922f2d1675f2ull, 0x42889b8997915ce8ull },
+    { 0x847c9b5d7c2e09b7ull, 0x69956135febada11ull },
+    { 0xa59bc234db398c25ull, 0x43fab9837e699095ull },
+    { 0xcf02b2c21207ef2eull, 0x94f967e45e03f4bbull },
+    { 0x8161afb94b44f57dull, 0x1d1be0eebac278f5ull },
+    { 0xa1ba1ba79e1632dcull, 0x6462d92a69731732ull },
+    { 0xca28a291859bbf93ull, 0x7d7b8f7503cfdcfeull },
+    { 0xfcb2cb35e702af78ull, 0x5cda735244c3d43eull },
+    { 0x9defbf01b061adabull, 0x3a0888136afa64a7ull },
+    { 0xc56baec21c7a1916ull, 0x088aaa1845b8fdd0ull },
+    { 0xf6c69a72a3989f5bull, 0x8aad549e57273d45ull },
+    { 0x9a3c2087a63f6399ull, 0x36ac54e2f678864bull },
+    { 0xc0cb28a98fcf3c7full, 0x84576a1bb416a7ddull },
+    { 0xf0fdf2d3f3c30b9full, 0x656d44a2a11c51d5ull },
+    { 0x969eb7c47859e743ull, 0x9f644ae5a4b1b325ull },
+    { 0xbc4665b596706114ull, 0x873d5d9f0dde1feeull },
+    { 0xeb57ff22fc0c7959ull, 0xa90cb506d155a7eaull },
+    { 0x9316ff75dd87cbd8ull, 0x09a7f12442d588f2ull },
+    { 0xb7dcbf5354e9beceull, 0x0c11ed6d538aeb2full },
+    { 0xe5d3ef282a242e81ull, 0x8f1668c8a86da5faull },
+    { 0x8fa475791a569d10ull, 0xf96e017d694487bcull },
+    { 0xb38d92d760ec4455ull, 0x37c981dcc395a9acull },
+    { 0xe070f78d3927556aull, 0x85bbe253f47b1417ull },
+    { 0x8c469ab843b89562ull, 0x93956d7478ccec8eull },
+    { 0xaf58416654a6babbull, 0x387ac8d1970027b2ull },
+    { 0xdb2e51bfe9d0696aull, 0x06997b05fcc0319eull },
+    { 0x88fcf317f22241e2ull, 0x441fece3bdf81f03ull },
+    { 0xab3c2fddeeaad25aull, 0xd527e81cad7626c3ull },
+    { 0xd60b3bd56a5586f1ull, 0x8a71e223d8d3b074ull },
+    { 0x85c7056562757456ull, 0xf6872d5667844e49ull },
+    { 0xa738c6bebb12d16cull, 0xb428f8ac016561dbull },
+    { 0xd106f86e69d785c7ull, 0xe13336d701beba52ull },
+    { 0x82a45b450226b39cull, 0xecc0024661173473ull },
+    { 0xa34d721642b06084ull, 0x27f002d7f95d0190ull },
+    { 0xcc20ce9bd35c78a5ull, 0x31ec038df7b441f4ull },
+    { 0xff290242c83396ceull, 0x7e67047175a15271ull },
+    { 0x9f79a169bd203e41ull, 0x0f0062c6e984d386ull },
+    { 0xc75809c42c684dd1ull, 0x52c07b78a3e60868ull },
+    { 0xf92e0c3537826145ull, 0xa7709a56ccdf8a82ull },
+    { 0x9bbcc7a142b17ccbull, 0x88a66076400bb691ull },
+    { 0xc2abf989935ddbfeull, 0x6acff893d00ea435ull },
+    { 0xf356f7ebf83552feull, 0x0583f6b8c4124d43ull },
+    { 0x98165af37b2153deull, 0xc3727a337a8b704aull },
+    { 0xbe1bf1b059e9a8d6ull, 0x744f18c0592e4c5cull },
+    { 0xeda2ee1c7064130cull, 0x1162def06f79df73ull },
+    { 0x9485d4d1c63e8be7ull, 0x8addcb5645ac2ba8ull },
+    { 0xb9a74a0637ce2ee1ull, 0x6d953e2bd7173692ull },
+    { 0xe8111c87c5c1ba99ull, 0xc8fa8db6ccdd0437ull },
+    { 0x910ab1d4db9914a0ull, 0x1d9c9892400a22a2ull },
+    { 0xb54d5e4a127f59c8ull, 0x2503beb6d00cab4bull },
+    { 0xe2a0b5dc971f303aull, 0x2e44ae64840fd61dull },
+    { 0x8da471a9de737e24ull, 0x5ceaecfed289e5d2ull },
+    { 0xb10d8e1456105dadull, 0x7425a83e872c5f47ull },
+    { 0xdd50f1996b947518ull, 0xd12f124e28f77719ull },
+    { 0x8a5296ffe33cc92full, 0x82bd6b70d99aaa6full },
+    { 0xace73cbfdc0bfb7bull, 0x636cc64d1001550bull },
+    { 0xd8210befd30efa5aull, 0x3c47f7e05401aa4eull },
+    { 0x8714a775e3e95c78ull, 0x65acfaec34810a71ull },
+    { 0xa8d9d1535ce3b396ull, 0x7f1839a741a14d0dull },
+    { 0xd31045a8341ca07cull, 0x1ede48111209a050ull },
+    { 0x83ea2b892091e44dull, 0x934aed0aab460432ull },
+    { 0xa4e4b66b68b65d60ull, 0xf81da84d5617853full },
+    { 0xce1de40642e3f4b9ull, 0x36251260ab9d668eull },
+    { 0x80d2ae83e9ce78f3ull, 0xc1d72b7c6b426019ull },
+    { 0xa1075a24e4421730ull, 0xb24cf65b8612f81full },
+    { 0xc94930ae1d529cfcull, 0xdee033f26797b627ull },
+    { 0xfb9b7cd9a4a7443cull, 0x169840ef017da3b1ull },
+    { 0x9d412e0806e88aa5ull, 0x8e1f289560ee864eull },
+    { 0xc491798a08a2ad4eull, 0xf1a6f2bab92a27e2ull },
+    { 0xf5b5d7ec8acb58a2ull, 0xae10af696774b1dbull },
+    { 0x9991a6f3d6bf1765ull, 0xacca6da1e0a8ef29ull },
+    { 0xbff610b0cc6edd3full, 0x17fd090a58d32af3ull },
+    { 0xeff394dcff8a948eull, 0xddfc4b4cef07f5b0ull },
+    { 0x95f83d0a1fb69cd9ull, 0x4abdaf101564f98eull },
+    { 0xbb764c4ca7a4440full, 0x9d6d1ad41abe37f1ull },
+    { 0xea53df5fd18d5513ull, 0x84c86189216dc5edull },
+    { 0x92746b9be2f8552cull, 0x32fd3cf5b4e49bb4ull },
+    { 0xb7118682dbb66a77ull, 0x3fbc8c33221dc2a1ull },
+    { 0xe4d5e82392a40515ull, 0x0fabaf3feaa5334aull },
+    { 0x8f05b1163ba6832dull, 0x29cb4d87f2a7400eull },
+    { 0xb2c71d5bca9023f8ull, 0x743e20e9ef511012ull },
+    { 0xdf78e4b2bd342cf6ull, 0x914da9246b255416ull },
+    { 0x8bab8eefb6409c1aull, 0x1ad089b6c2f7548eull },
+    { 0xae9672aba3d0c320ull, 0xa184ac2473b529b1ull },
+    { 0xda3c0f568cc4f3e8ull, 0xc9e5d72d90a2741eull },
+    { 0x8865899617fb1871ull, 0x7e2fa67c7a658892ull },
+    { 0xaa7eebfb9df9de8dull, 0xddbb901b98feeab7ull },
+    { 0xd51ea6fa85785631ull, 0x552a74227f3ea565ull },
+    { 0x8533285c936b35deull, 0xd53a88958f87275full },
+    { 0xa67ff273b8460356ull, 0x8a892abaf368f137ull },
+    { 0xd01fef10a657842cull, 0x2d2b7569b0432d85ull },
+    { 0x8213f56a67f6b29bull, 0x9c3b29620e29fc73ull },
+    { 0xa298f2c501f45f42ull, 0x8349f3ba91b47b8full },
+    { 0xcb3f2f7642717713ull, 0x241c70a936219a73ull },
+    { 0xfe0efb53d30dd4d7ull, 0xed238cd383aa0110ull },
+    { 0x9ec95d1463e8a506ull, 0xf4363804324a40aaull },
+    { 0xc67bb4597ce2ce48ull, 0xb143c6053edcd0d5ull },
+    { 0xf81aa16fdc1b81daull, 0xdd94b7868e94050aull },
+    { 0x9b10a4e5e9913128ull, 0xca7cf2b4191c8326ull },
+    { 0xc1d4ce1f63f57d72ull, 0xfd1c2f611f63a3f0ull },
+    { 0xf24a01a73cf2dccfull, 0xbc633b39673c8cecull },
+    { 0x976e41088617ca01ull, 0xd5be0503e085d813ull },
+    { 0xbd49d14aa79dbc82ull, 0x4b2d8644d8a74e18ull },
+    { 0xec9c459d51852ba2ull, 0xddf8e7d60ed1219eull },
+    { 0x93e1ab8252f33b45ull, 0xcabb90e5c942b503ull },
+    { 0xb8da1662e7b00a17ull, 0x3d6a751f3b936243ull },
+    { 0xe7109bfba19c0c9dull, 0x0cc512670a783ad4ull },
+    { 0x906a617d450187e2ull, 0x27fb2b80668b24c5ull },
+    { 0xb484f9dc9641e9daull, 0xb1f9f660802dedf6ull },
+    { 0xe1a63853bbd26451ull, 0x5e7873f8a0396973ull },
+    { 0x8d07e33455637eb2ull, 0xdb0b487b6423e1e8ull },
+    { 0xb049dc016abc5e5full, 0x91ce1a9a3d2cda62ull },
+    { 0xdc5c5301c56b75f7ull, 0x7641a140cc7810fbull },
+    { 0x89b9b3e11b6329baull, 0xa9e904c87fcb0a9dull },
+    { 0xac2820d9623bf429ull, 0x546345fa9fbdcd44ull },
+    { 0xd732290fbacaf133ull, 0xa97c177947ad4095ull },
+    { 0x867f59a9d4bed6c0ull, 0x49ed8eabcccc485dull },
+    { 0xa81f301449ee8c70ull, 0x5c68f256bfff5a74ull },
+    { 0xd226fc195c6a2f8cull, 0x73832eec6fff3111ull },
+    { 0x83585d8fd9c25db7ull, 0xc831fd53c5ff7eabull },
+    { 0xa42e74f3d032f525ull, 0xba3e7ca8b77f5e55ull },
+    { 0xcd3a1230c43fb26full, 0x28ce1bd2e55f35ebull },
+    { 0x80444b5e7aa7cf85ull, 0x7980d163cf5b81b3ull },
+    { 0xa0555e361951c366ull, 0xd7e105bcc332621full },
+    { 0xc86ab5c39fa63440ull, 0x8dd9472bf3fefaa7ull },
+    { 0xfa856334878fc150ull, 0xb14f98f6f0feb951ull },
+    { 0x9c935e00d4b9d8d2ull, 0x6ed1bf9a569f33d3ull },
+    { 0xc3b8358109e84f07ull, 0x0a862f80ec4700c8ull },
+    { 0xf4a642e14c6262c8ull, 0xcd27bb612758c0faull },
+    { 0x98e7e9cccfbd7dbdull, 0x8038d51cb897789cull },
+    { 0xbf21e44003acdd2cull, 0xe0470a63e6bd56c3ull },
+    { 0xeeea5d5004981478ull, 0x1858ccfce06cac74ull },
+    { 0x95527a5202df0ccbull, 0x0f37801e0c43ebc8ull },
+    { 0xbaa718e68396cffdull, 0xd30560258f54e6baull },
+    { 0xe950df20247c83fdull, 0x47c6b82ef32a2069ull },
+    { 0x91d28b7416cdd27eull, 0x4cdc331d57fa5441ull },
+    { 0xb6472e511c81471dull, 0xe0133fe4adf8e952ull },
+    { 0xe3d8f9e563a198e5ull, 0x58180fddd97723a6ull },
+    { 0x8e679c2f5e44ff8full, 0x570f09eaa7ea7648ull },
+};
+
+// Bits of the double closest to w * 10^q with the Eisel-Lemire algorithm.
+// w must be below 10^19, which makes the 128 bit product always enough.
+static u64_t _es_eisel_lemire(u64_t w, i32_t q) {
+    if (w == 0 || q < -342) {
+        return 0;
+    }
+    if (q > 308) {
+        return 0x7ff0000000000000ull;
+    }
 
-        start++;
-        end--;
+    i32_t lz = __builtin_clzll(w);
+    w <<= lz;
+
+    // Only the upper 55 bits matter. The lower half of the power is needed
+    // when the rest of them could carry into those.
+    usize_t index = q + 342;
+    u64_t lo = w;
+    u64_t hi = _es_pow5_128[index].hi;
+    _es_wymum(&lo, &hi);
+    if ((hi & 0x1ff) == 0x1ff) {
+        u64_t second_lo = w;
+        u64_t second_hi = _es_pow5_128[index].lo;
+        _es_wymum(&second_lo, &second_hi);
+        lo += second_hi;
+        hi += second_hi > lo;
     }
-}
 
-es_str_t es_str_sub_start(const char *str, usize_t len) {
-    return es_str_sub_len(str, 0, len);
-}
+    i32_t upper_bit = hi >> 63;
+    u64_t mantissa = hi >> (upper_bit + 9);
+    // floor(log2(10^q)) + 63 + upper_bit - lz, biased.
+    i32_t power2 = (((152170 + 65536) * q) >> 16) + 63 + upper_bit - lz + 1023;
 
-es_str_t es_str_sub_end(const char *str, usize_t len) {
-    return es_str_sub_len(str, es_cstr_len(str) - len, len);
-}
+    if (power2 <= 0) {
+        // Subnormal, or zero when everything is shifted out.
+        if (-power2 + 1 >= 64) {
+            return 0;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        // Rounding up may reach the smallest normal.
+        return mantissa < (1ull << 52) ? mantissa : (1ull << 52);
+    }
 
-es_str_t es_str_sub_index(const char *str, usize_t start, usize_t end) {
-    es_assert(start <= end, "Starting index can't be greater than end index.", NULL);
-    return es_str_sub_len(str, start, end - start + 1);
+    // Exactly halfway between two doubles rounds to even. Only products of
+    // small powers of ten can land there.
+    if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << (upper_bit + 9)) == hi) {
+        mantissa &= ~1ull;
+    }
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (2ull << 52)) {
+        mantissa = 1ull << 52;
+        power2++;
+    }
+    mantissa &= ~(1ull << 52);
+    if (power2 >= 0x7ff) {
+        return 0x7ff0000000000000ull;
+    }
+    return (u64_t) power2 << 52 | mantissa;
 }
 
-es_str_t es_str_sub_len(const char *str, usize_t start, usize_t len) {
-    es_str_t result = es_strn(str + start, len);
+// Parse with strtod, swapping the decimal point for the one of the current locale.
+static f64_t _es_parse_f64_strtod(const char *s, usize_t len) {
+    const char *point = localeconv()->decimal_point;
+    usize_t point_len = es_cstr_len(point);
+    char local[128];
+    usize_t size = len * point_len + 1;
+    char *copy = size <= sizeof(local) ? local : es_malloc(size);
+
+    usize_t j = 0;
+    for (usize_t i = 0; i < len; i++) {
+        if (s[i] == '.') {
+            memcpy(copy + j, point, point_len);
+            j += point_len;
+        } else {
+            copy[j++] = s[i];
+        }
+    }
+    copy[j] = '\0';
+
+    f64_t result = strtod(copy, NULL);
+    if (copy != local) {
+        es_free(copy);
+    }
     return result;
 }
 
-es_da(es_str_t) es_str_split_by_delim(const char *str, char delim) {
-    es_da(es_str_t) result = NULL;
+usize_t es_parse_f64(es_strview_t str, f64_t *value) {
+    const char *s = str.data;
+    usize_t i = 0;
+    b8_t negative = false;
+    if (str.len > 0 && (s[0] == '-' || s[0] == '+')) {
+        negative = s[0] == '-';
+        i++;
+    }
+    usize_t sign = i;
 
-    usize_t start = 0, end;
-    for (usize_t i = 0; i < es_cstr_len(str) + 1; i++) {
-        if (str[i] == delim || str[i] == '\0') {
-            end = i - 1;
-            es_da_push(result, es_str_sub_index(str, start, end));
-            i++;
-            start = i;
+    usize_t word;
+    es_strview_t rest = es_strview_skip(str, i);
+    if ((word = _es_parse_word(rest, "infinity")) || (word = _es_parse_word(rest, "inf"))) {
+        *value = negative ? -INFINITY : INFINITY;
+        return i + word;
+    }
+    if ((word = _es_parse_word(rest, "nan"))) {
+        *value = negative ? -NAN : NAN;
+        return i + word;
+    }
+
+    // Keep the first 19 significant digits, which always fit.
+    u64_t mantissa = 0;
+    usize_t digits = 0;
+    i32_t exponent = 0;
+    b8_t truncated = false;
+    b8_t any_digits = false;
+
+    for (; i < str.len && es_is_digit(s[i]); i++) {
+        any_digits = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (s[i] - '0');
+            digits += mantissa != 0;
+        } else {
+            exponent++;
+            truncated |= s[i] != '0';
         }
     }
+    if (i < str.len && s[i] == '.') {
+        i++;
+        for (; i < str.len && es_is_digit(s[i]); i++) {
+            any_digits = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (s[i] - '0');
+                digits += mantissa != 0;
+                exponent--;
+            } else {
+                truncated |= s[i] != '0';
+            }
+        }
+    }
+    if (!any_digits) {
+        return 0;
+    }
 
-    return result;
-}
+    // Exponents only count when digits follow.
+    if (i < str.len && (s[i] == 'e' || s[i] == 'E')) {
+        usize_t j = i + 1;
+        b8_t exponent_negative = false;
+        if (j < str.len && (s[j] == '-' || s[j] == '+')) {
+            exponent_negative = s[j] == '-';
+            j++;
+        }
+        if (j < str.len && es_is_digit(s[j])) {
+            i32_t explicit_exponent = 0;
+            for (; j < str.len && es_is_digit(s[j]); j++) {
+                // Anything this large is already zero or infinity.
+                if (explicit_exponent < 100000) {
+                    explicit_exponent = explicit_exponent * 10 + (s[j] - '0');
+                }
+            }
+            exponent += exponent_negative ? -explicit_exponent : explicit_exponent;
+            i = j;
+        }
+    }
 
-i32_t es_str_cmp(es_str_t str, const char *b) {
-    return es_cstr_cmp_len(str, b, es_str_len(str) + 1);
-}
+    // Move extra powers of ten into the mantissa while it stays exact.
+    while (exponent > 22 && mantissa < (1ull << 53) / 10) {
+        mantissa *= 10;
+        exponent--;
+    }
 
-void _es_str_resize(es_str_t *str, usize_t len) {
-    _es_str_head_t *head = _es_str_head(*str);
-    _es_str_head_t *new_head = realloc(head, sizeof(_es_str_head_t) + head->len + len + 1);
-    if (new_head == NULL) {
-        head->valid = false;
+    // An exact mantissa and power of ten need a single correctly rounded
+    // operation. Everything else goes through Eisel-Lemire.
+    f64_t result;
+    if (!truncated && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22) {
+        result = (f64_t) mantissa;
+        if (exponent < 0) {
+            result /= _es_exact_pow10[-exponent];
+        } else {
+            result *= _es_exact_pow10[exponent];
+        }
     } else {
-        head = new_head;
-        head->len += len;
+        u64_t bits = _es_eisel_lemire(mantissa, exponent);
+        // Dropped digits put the value between mantissa and mantissa + 1.
+        // Only when those round differently does it take strtod.
+        if (truncated && _es_eisel_lemire(mantissa + 1, exponent) != bits) {
+            result = _es_parse_f64_strtod(s + sign, i - sign);
+        } else {
+            memcpy(&result, &bits, sizeof(result));
+        }
     }
-    *str = _es_str_ptr(head);
-    (*str)[head->len] = '\0';
+    if (negative) {
+        result = -result;
+    }
+
+    *value = result;
+    return i;
 }
 
-usize_t es_cstr_len(const char *str) {
-    usize_t len = 0;
-    while (str[len++] != '\0');
-    return len - 1;
+/*=========================*/
+// String interning
+/*=========================*/
+
+es_intern_t es_intern_init(void) {
+    es_intern_t intern = {0};
+    intern.arena = es_arena_init(0);
+    return intern;
 }
 
-i32_t es_cstr_cmp_len(const char *a, const char *b, usize_t len) {
-    while (len-- - 1) {
-        if (*a != *b) {
-            break;
-        }
+void es_intern_free(es_intern_t *intern) {
+    es_assert(intern != NULL, "Can't free a NULL interner.", NULL);
 
-        a++;
-        b++;
-    }
+    es_arena_free(&intern->arena);
+    es_da_free(intern->strings);
+    es_hash_table_free(intern->ids);
+    *intern = es_intern_init();
+}
 
-    return *(const u8_t *) a - *(const u8_t *) b;
+u32_t es_intern(es_intern_t *intern, const char *str) {
+    u32_t id = es_intern_find(intern, str);
+    if (id != ES_INTERN_NONE) {
+        return id;
+    }
+    return es_intern_len(intern, str, es_cstr_len(str));
 }
 
-i32_t es_cstr_cmp(const char *a, const char *b) {
-    while (*a) {
-        if (*a != *b) {
-            break;
-        }
+u32_t es_intern_len(es_intern_t *intern, const char *str, usize_t len) {
+    es_assert(intern != NULL, "Can't intern into a NULL interner.", NULL);
 
-        a++;
-        b++;
+    if (intern->strings == NULL) {
+        es_da_push(intern->strings, NULL);
+        es_hash_table_string_key(intern->ids);
     }
 
-    return *(const u8_t *) a - *(const u8_t *) b;
+    // The key has to be terminated, so copy first and give the memory back if it's already interned.
+    es_arena_mark_t mark = es_arena_mark(&intern->arena);
+    char *copy = es_arena_alloc(&intern->arena, len + 1);
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    u32_t id = es_hash_table_get(intern->ids, copy);
+    if (id != ES_INTERN_NONE) {
+        es_arena_rewind(&intern->arena, mark);
+        return id;
+    }
+
+    id = es_da_count(intern->strings);
+    es_da_push(intern->strings, copy);
+    es_hash_table_insert(intern->ids, copy, id);
+    return id;
 }
 
-b8_t es_is_whitespace(char c) {
-    return (c == ' ' || c == '\t' || c == '\f' || c == '\r' || c == '\n');
+u32_t es_intern_view(es_intern_t *intern, es_strview_t view) {
+    return es_intern_len(intern, view.data, view.len);
 }
 
-b8_t es_is_alpha(char c) {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+u32_t es_intern_find(const es_intern_t *intern, const char *str) {
+    es_assert(intern != NULL, "Can't search a NULL interner.", NULL);
+
+    if (intern->strings == NULL) {
+        return ES_INTERN_NONE;
+    }
+    return es_hash_table_get(intern->ids, str);
 }
 
-b8_t es_is_digit(char c) {
-    return (c >= '0' && c <= '9');
+u32_t es_intern_find_len(const es_intern_t *intern, const char *str, usize_t len) {
+    // Lookups need a terminated key. Short ones, which is most of them, are copied to the stack.
+    char buffer[128];
+    char *key = len < sizeof(buffer) ? buffer : es_malloc(len + 1);
+    memcpy(key, str, len);
+    key[len] = '\0';
+
+    u32_t id = es_intern_find(intern, key);
+    if (key != buffer) {
+        es_free(key);
+    }
+    return id;
+}
+
+const char *es_intern_str(const es_intern_t *intern, u32_t id) {
+    es_assert(intern != NULL, "Can't get a string from a NULL interner.", NULL);
+    es_assert(id != ES_INTERN_NONE && id < es_da_count(intern->strings), "Invalid intern id %u.", id);
+    return intern->strings[id];
+}
+
+usize_t es_intern_count(const es_intern_t *intern) {
+    es_assert(intern != NULL, "Can't count a NULL interner.", NULL);
+    return intern->strings == NULL ? 0 : es_da_count(intern->strings) - 1;
 }
 
 /*=========================*/
@@ -870,6 +4905,7 @@ mat4_t mat4_inverse(mat4_t mat) {
 
 _es_profile_t _es_root_profile = {0};
 _es_profile_t *_es_curr_profile = &_es_root_profile;
+es_intern_t _es_profile_names = {0};
 
 _es_profile_t _es_profile_new(const char *name) {
     _es_profile_t prof = {
@@ -879,26 +4915,46 @@ _es_profile_t _es_profile_new(const char *name) {
     return prof;
 }
 
+// Enter a child of the current profile.
+static void _es_profile_enter(_es_profile_t *prof, const char *name) {
+    prof->site_name = name;
+    _es_curr_profile = prof;
+    prof->t0 = es_get_time();
+    prof->runs++;
+}
+
 void _es_profile_begin(const char *name) {
     // No binary search because profile order should be preserved.
     // Shouldn't matter since there shouldn't be a large number or profiles.
-    b8_t registred = false;
-    for (usize_t i = 0; i < es_da_count(_es_curr_profile->children); i++) {
-        // Profile already registered.
-        if (es_cstr_cmp(_es_curr_profile->children[i].name, name) == 0) {
-            _es_curr_profile = &_es_curr_profile->children[i];
-            registred = true;
-            break;
+    usize_t count = es_chunked_da_count(_es_curr_profile->children);
+
+    // Blocks usually pass the same literal every run, so the pointer finds the
+    // profile without hashing. The compare catches buffers reused for another name.
+    for (usize_t i = 0; i < count; i++) {
+        _es_profile_t *child = &es_chunked_da_at(_es_curr_profile->children, i);
+        if (child->site_name == name && es_cstr_cmp(child->name, name) == 0) {
+            _es_profile_enter(child, name);
+            return;
         }
     }
-    // Register a new profile.
-    if (!registred) {
-        es_da_push(_es_curr_profile->children, _es_profile_new(name));
-        _es_curr_profile = &es_da_last(_es_curr_profile->children);
+
+    // Otherwise the name is hashed once, so children are matched by id.
+    u32_t name_id = es_intern(&_es_profile_names, name);
+    for (usize_t i = 0; i < count; i++) {
+        _es_profile_t *child = &es_chunked_da_at(_es_curr_profile->children, i);
+        // Profile already registered.
+        if (child->name_id == name_id) {
+            _es_profile_enter(child, name);
+            return;
+        }
     }
 
-    _es_curr_profile->t0 = es_get_time();
-    _es_curr_profile->runs++;
+    // Register a new profile.
+    // Children are chunked so parent pointers survive siblings being added.
+    es_chunked_da_push(_es_curr_profile->children, _es_profile_new(es_intern_str(&_es_profile_names, name_id)));
+    _es_profile_t *prof = &es_chunked_da_last(_es_curr_profile->children);
+    prof->name_id = name_id;
+    _es_profile_enter(prof, name);
 }
 
 void _es_profile_end(void) {
@@ -911,16 +4967,16 @@ void _es_profile_print(const _es_profile_t *prof, usize_t gen) {
         printf("    ");
     }
     printf("%s: %f %f %d\n", prof->name, prof->time, prof->time / prof->runs, prof->runs);
-    for (usize_t i = 0; i < es_da_count(prof->children); i++) {
-        _es_profile_print(&prof->children[i], gen + 1);
+    for (usize_t i = 0; i < es_chunked_da_count(prof->children); i++) {
+        _es_profile_print(&es_chunked_da_at(prof->children, i), gen + 1);
     }
 }
 
 void es_profile_print(void) {
     printf("========== Profile ==========\n");
     printf("Name: total_time avarage_time run_count\n");
-    for (usize_t i = 0; i < es_da_count(_es_root_profile.children); i++) {
-        _es_profile_print(&_es_root_profile.children[i], 0);
+    for (usize_t i = 0; i < es_chunked_da_count(_es_root_profile.children); i++) {
+        _es_profile_print(&es_chunked_da_at(_es_root_profile.children, i), 0);
     }
     printf("========== End ==========\n");
 }
@@ -1898,7 +5954,7 @@ _es_formatter_t _es_formatter_g = {0};
 
 void es_formatter_init(void) {
     es_assert(!_es_formatter_g.initialized, "Formatter has already been initialized.", NULL);
-    es_hash_table_string_key(_es_formatter_g.formats);
+    _es_formatter_g.names = es_intern_init();
     _es_formatter_g.initialized = true;
 
     es_formatter_add_format("u64", _es_format_expander_u64);
@@ -1924,19 +5980,24 @@ void es_formatter_init(void) {
 
 void es_formatter_free(void) {
     es_assert(_es_formatter_g.initialized, "Formatter hasn't been initialized.", NULL);
-    es_hash_table_free(_es_formatter_g.formats);
+    es_intern_free(&_es_formatter_g.names);
+    es_da_free(_es_formatter_g.expanders);
     _es_formatter_g.initialized = false;
 }
 
 void es_formatter_add_format(const char *trigger, es_format_expander_t expander) {
     es_assert(_es_formatter_g.initialized, "Formatter hasn't been initialized.", NULL);
-    es_hash_table_insert(_es_formatter_g.formats, trigger, expander);
+    u32_t id = es_intern(&_es_formatter_g.names, trigger);
+    while (es_da_count(_es_formatter_g.expanders) <= id) {
+        es_da_push(_es_formatter_g.expanders, NULL);
+    }
+    _es_formatter_g.expanders[id] = expander;
 }
 
 es_str_t _es_format(const char *fmt, va_list va_ptr) {
     es_assert(_es_formatter_g.initialized, "Formatter hasn't been initialized.", NULL);
 
-    es_str_t final = es_str_empty();
+    es_str_builder_t final = es_str_builder();
 
     i32_t i = 0;
     char c = fmt[i];
@@ -1957,27 +6018,34 @@ es_str_t _es_format(const char *fmt, va_list va_ptr) {
             // Skip the trailing '}'.
             i++;
 
-            es_str_t format = es_str_sub_index(fmt, start, end);
-            es_da(es_str_t) format_list = es_str_split_by_delim(format, ' ');
-            es_str_free(&format);
-            es_da_remove(format_list, 0, &format);
+            // The name is looked up through a view, so only arguments get allocated.
+            es_strview_split_t split = es_strview_split(es_strview_len(fmt + start, end - start + 1), ' ');
+            es_strview_t format;
+            es_strview_split_next(&split, &format);
+            // Formats rarely take more than a few arguments so keep them off the heap.
+            es_sda(es_str_t, 4) format_storage;
+            es_da(es_str_t) format_list = es_sda_init(format_storage);
+            es_strview_t arg;
+            while (es_strview_split_next(&split, &arg)) {
+                es_da_push(format_list, es_str_view(arg));
+            }
 
-            es_format_expander_t expander = es_hash_table_get(_es_formatter_g.formats, format);
-            es_assert(expander != NULL, "No expander for '%s' formatting.", format);
+            u32_t format_id = es_intern_find_len(&_es_formatter_g.names, format.data, format.len);
+            es_format_expander_t expander = format_id < es_da_count(_es_formatter_g.expanders) ? _es_formatter_g.expanders[format_id] : NULL;
+            es_assert(expander != NULL, "No expander for '%.*s' formatting.", (i32_t) format.len, format.data);
             es_str_t expanded = expander(format_list, va_ptr);
 
-            es_str_concat_len(&final, expanded, es_str_len(expanded));
-            es_str_free(&format);
+            es_str_builder_append_len(&final, expanded, es_str_len(expanded));
             es_str_free(&expanded);
             es_str_free_list(&format_list);
         } else {
-            es_str_concat_char(&final, c);
+            es_str_builder_append_char(&final, c);
         }
 
         escape = false;
     }
 
-    return final;
+    return es_str_builder_finish(&final);
 }
 
 es_str_t es_format(const char *fmt, ...) {
@@ -2011,49 +6079,58 @@ es_str_t es_format_expand(const char *fmt, ...) {
     return es_str(buff);
 }
 
+// Format the value after conversion with a printf conversion, putting the formatting argument in front of it.
+static es_str_t _es_format_printf(es_da(es_str_t) args, const char *conversion, ...) {
+    char format[64];
+    snprintf(format, sizeof(format), "%%%s%s", args[0], conversion);
+
+    va_list ptr;
+    va_list copy;
+    va_start(ptr, conversion);
+    va_copy(copy, ptr);
+    i32_t len = vsnprintf(NULL, 0, format, ptr);
+    va_end(ptr);
+    if (len < 0) {
+        va_end(copy);
+        return es_str_empty();
+    }
+
+    es_str_t str = es_str_reserve(len);
+    vsnprintf(str, len + 1, format, copy);
+    va_end(copy);
+    return str;
+}
+
 es_str_t _es_format_expander_u64(es_da(es_str_t) args, va_list va_ptr) {
     es_assert(es_da_count(args) < 2, "u64 formatting only takes 0 or 1 arguments.", NULL);
 
-    es_str_t format = NULL;
+    u64_t value = va_arg(va_ptr, u64_t);
     if (es_da_count(args) == 1) {
-        format = es_format_expand("%%%sllu", args[0]);
-    } else {
-        format = es_str("%llu");
+        return _es_format_printf(args, "llu", value);
     }
-    u64_t value = va_arg(va_ptr, u64_t);
-    es_str_t expanded = es_format_expand(format, value);
-    es_str_free(&format);
-    return expanded;
+    return es_str_u64(value);
 }
 
 es_str_t _es_format_expander_i64(es_da(es_str_t) args, va_list va_ptr) {
     es_assert(es_da_count(args) < 2, "i64 formatting only takes 0 or 1 arguments.", NULL);
 
-    es_str_t format = NULL;
+    i64_t value = va_arg(va_ptr, i64_t);
     if (es_da_count(args) == 1) {
-        format = es_format_expand("%%%slld", args[0]);
-    } else {
-        format = es_str("%lld");
+        return _es_format_printf(args, "lld", value);
     }
-    i64_t value = va_arg(va_ptr, i64_t);
-    es_str_t expanded = es_format_expand(format, value);
-    es_str_free(&format);
-    return expanded;
+    return es_str_i64(value);
 }
 
 es_str_t _es_format_expander_f64(es_da(es_str_t) args, va_list va_ptr) {
     es_assert(es_da_count(args) < 2, "f64 formatting only takes 0 or 1 arguments.", NULL);
 
-    es_str_t format = NULL;
+    f64_t value = va_arg(va_ptr, f64_t);
     if (es_da_count(args) == 1) {
-        format = es_format_expand("%%%sf", args[0]);
-    } else {
-        format = es_str("%f");
+        return _es_format_printf(args, "f", value);
     }
-    f64_t value = va_arg(va_ptr, f64_t);
-    es_str_t expanded = es_format_expand(format, value);
-    es_str_free(&format);
-    return expanded;
+    es_str_builder_t builder = es_str_builder();
+    es_str_builder_appendf(&builder, "%f", value);
+    return es_str_builder_finish(&builder);
 }
 
 es_str_t _es_format_expander_b8(es_da(es_str_t) args, va_list va_ptr) {
@@ -115,3 +115,378 @@ es_unit(dynamic_array_count) {
 
     es_unit_check(es_da_count(da) == 9);
 }
+
+es_unit(dynamic_array_reserve) {
+    es_da(i32_t) da = NULL;
+    es_da_reserve(da, 100);
+    i32_t *ptr = da;
+    for (i32_t i = 0; i < 100; i++) {
+        es_da_push(da, i);
+    }
+
+    b8_t success = (da == ptr && es_da_cap(da) == 100 && da[99] == 99);
+    es_da_free(da);
+    es_unit_check(success);
+}
+
+es_unit(dynamic_array_shrink_to_fit) {
+    es_da(i32_t) da = NULL;
+    fill_da(&da);
+    es_da_reserve(da, 100);
+    es_da_shrink_to_fit(da);
+
+    b8_t success = (es_da_cap(da) == 9 && memcmp(da, &(i32_t[9]) {-4, -3, -2, -1, 0, 1, 2, 3, 4}, 9 * sizeof(i32_t)) == 0);
+    es_da_free(da);
+    es_unit_check(success);
+}
+
+es_unit(dynamic_array_shrink_hysteresis) {
+    es_da(i32_t) da = NULL;
+    for (i32_t i = 0; i < 64; i++) {
+        es_da_push(da, i);
+    }
+    usize_t cap = es_da_cap(da);
+
+    // Oscillating around a power of two keeps the capacity.
+    b8_t success = true;
+    for (i32_t i = 0; i < 8; i++) {
+        es_da_pop(da, NULL);
+        es_da_push(da, i);
+        success = (es_da_cap(da) == cap) && success;
+    }
+
+    // Dropping to a quarter halves the capacity.
+    es_da_pop_arr(da, 48, NULL);
+    success = (es_da_cap(da) == cap / 2) && success;
+
+    es_da_free(da);
+    es_unit_check(success);
+}
+
+es_unit(dynamic_array_append_n) {
+    es_da(i32_t) da = NULL;
+    es_da_push(da, 1);
+    es_da_append_n(da, 7, 1000);
+
+    b8_t success = (es_da_count(da) == 1001 && da[0] == 1 && da[1] == 7 && da[1000] == 7);
+    es_da_free(da);
+    es_unit_check(success);
+}
+
+es_unit(dynamic_array_extend_from) {
+    es_da(i32_t) a = NULL;
+    es_da(i32_t) b = NULL;
+    fill_da(&a);
+    fill_da(&b);
+    es_da_extend_from(a, b);
+    // Extending with itself reads from the reallocated array.
+    es_da_extend_from(b, b);
+
+    b8_t success = (es_da_count(a) == 18 && es_da_count(b) == 18 && memcmp(a, b, 18 * sizeof(i32_t)) == 0 && a[9] == -4);
+    es_da_free(a);
+    es_da_free(b);
+    es_unit_check(success);
+}
+
+es_unit(dynamic_array_splice) {
+    es_da(i32_t) da = NULL;
+    fill_da(&da);
+
+    es_da_splice(da, 1, 3, ((i32_t [2]) {10, 11}), 2);
+    b8_t success = (memcmp(da, &(i32_t [8]) {-4, 10, 11, 0, 1, 2, 3, 4}, 8 * sizeof(i32_t)) == 0);
+    es_da_splice(da, 7, 1, ((i32_t [3]) {5, 6, 7}), 3);
+    success = (es_da_count(da) == 10 && memcmp(da, &(i32_t [10]) {-4, 10, 11, 0, 1, 2, 3, 5, 6, 7}, 10 * sizeof(i32_t)) == 0) && success;
+
+    es_da_free(da);
+    es_unit_check(success);
+}
+
+es_unit(dynamic_array_resize_uninit) {
+    es_da(i32_t) da = NULL;
+    es_da_resize_uninit(da, 1000);
+    for (i32_t i = 0; i < 1000; i++) {
+        da[i] = i;
+    }
+
+    b8_t success = (es_da_count(da) == 1000 && es_da_cap(da) == 1000 && da[999] == 999);
+    es_da_free(da);
+    es_unit_check(success);
+}
+
+es_unit(dynamic_array_clear) {
+    es_da(i32_t) da = NULL;
+    fill_da(&da);
+    usize_t cap = es_da_cap(da);
+    es_da_clear(da);
+
+    b8_t success = (es_da_count(da) == 0 && es_da_cap(da) == cap);
+    es_da_free(da);
+    es_unit_check(success);
+}
+
+es_unit(dynamic_array_push_self_reference) {
+    es_da(i32_t) da = NULL;
+    fill_da(&da);
+    es_da_shrink_to_fit(da);
+    // Value is read before the array grows.
+    es_da_push(da, da[0]);
+
+    b8_t success = (es_da_count(da) == 10 && es_da_last(da) == -4);
+    es_da_free(da);
+    es_unit_check(success);
+}
+
+es_unit(small_dynamic_array_inline) {
+    es_sda(i32_t, 8) storage;
+    es_da(i32_t) da = es_sda_init(storage);
+    for (i32_t i = 0; i < 8; i++) {
+        es_da_push(da, i);
+    }
+    es_da_pop(da, NULL);
+
+    b8_t success = (da == storage.inline_data && es_sda_is_inline(da) && es_da_count(da) == 7 && es_da_cap(da) == 8);
+    es_da_free(da);
+    es_unit_check(success);
+}
+
+es_unit(small_dynamic_array_spill) {
+    es_sda(i32_t, 4) storage;
+    es_da(i32_t) da = es_sda_init(storage);
+    for (i32_t i = 0; i < 100; i++) {
+        es_da_push(da, i);
+    }
+
+    b8_t success = (!es_sda_is_inline(da) && es_da_count(da) == 100 && da[3] == 3 && da[99] == 99);
+    es_da_free(da);
+    es_unit_check(success);
+}
+
+static i32_t cmp_i32(const void *a, const void *b) {
+    i32_t x = *(const i32_t *) a, y = *(const i32_t *) b;
+    return (x > y) - (x < y);
+}
+
+typedef struct sort_pair_t {
+    i32_t key;
+    i32_t order;
+} sort_pair_t;
+
+static i32_t cmp_sort_pair(const void *a, const void *b) {
+    return cmp_i32(&((const sort_pair_t *) a)->key, &((const sort_pair_t *) b)->key);
+}
+
+static b8_t is_sorted_i32(es_da(i32_t) da) {
+    for (usize_t i = 1; i < es_da_count(da); i++) {
+        if (da[i - 1] > da[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+es_unit(dynamic_array_sort) {
+    es_da(i32_t) da = NULL;
+    u32_t seed = 1;
+    for (i32_t i = 0; i < 1000; i++) {
+        seed = seed * 1103515245 + 12345;
+        es_da_push(da, (i32_t) (seed >> 16) % 100);
+    }
+    es_da_sort(da, cmp_i32);
+
+    b8_t success = (es_da_count(da) == 1000 && is_sorted_i32(da));
+    es_da_free(da);
+    es_unit_check(success);
+}
+
+es_unit(dynamic_array_sort_parallel) {
+    es_da(i32_t) da = NULL;
+    usize_t count = ES_DA_SORT_PARALLEL_THRESHOLD * 3 + 7;
+    es_da_resize_uninit(da, count);
+    for (usize_t i = 0; i < count; i++) {
+        da[i] = (i32_t) (count - i);
+    }
+    es_da_sort(da, cmp_i32);
+
+    b8_t success = (is_sorted_i32(da) && da[0] == 1 && da[count - 1] == (i32_t) count);
+    es_da_free(da);
+    es_unit_check(success);
+}
+
+es_unit(dynamic_array_sort_stable) {
+    b8_t success = true;
+    usize_t counts[] = { 100, ES_DA_SORT_PARALLEL_THRESHOLD * 2 + 3 };
+    for (usize_t c = 0; c < es_arr_len(counts); c++) {
+        es_da(sort_pair_t) da = NULL;
+        es_da_resize_uninit(da, counts[c]);
+        for (usize_t i = 0; i < counts[c]; i++) {
+            da[i] = (sort_pair_t) { (i32_t) ((i * 7919) % 13), (i32_t) i };
+        }
+        es_da_sort_stable(da, cmp_sort_pair);
+
+        for (usize_t i = 1; i < counts[c]; i++) {
+            b8_t ordered = da[i - 1].key < da[i].key || (da[i - 1].key == da[i].key && da[i - 1].order < da[i].order);
+            success = ordered && success;
+        }
+        es_da_free(da);
+    }
+    es_unit_check(success);
+}
+
+es_unit(dynamic_array_bsearch) {
+    es_da(i32_t) da = NULL;
+    for (i32_t i = 0; i < 10; i++) {
+        es_da_push(da, i * 2);
+        es_da_push(da, i * 2);
+    }
+
+    i32_t present = 8, missing = 9, past = 100;
+    i32_t *found = es_da_bsearch(da, &present, cmp_i32);
+    b8_t success = (found != NULL && *found == 8 &&
+                    es_da_bsearch(da, &missing, cmp_i32) == NULL &&
+                    es_da_lower_bound(da, &present, cmp_i32) == 8 &&
+                    es_da_lower_bound(da, &missing, cmp_i32) == 10 &&
+                    es_da_lower_bound(da, &past, cmp_i32) == 20);
+    es_da_free(da);
+    es_unit_check(success);
+}
+
+es_unit(chunked_dynamic_array_stable_addresses) {
+    es_chunked_da(i32_t) cda = {0};
+    es_chunked_da_push(cda, 42);
+    i32_t *first = &es_chunked_da_at(cda, 0);
+    for (i32_t i = 1; i < 10000; i++) {
+        es_chunked_da_push(cda, i);
+    }
+
+    b8_t success = (first == &es_chunked_da_at(cda, 0) && *first == 42 &&
+                    es_chunked_da_count(cda) == 10000 &&
+                    es_chunked_da_at(cda, 9999) == 9999 && es_chunked_da_last(cda) == 9999);
+    es_chunked_da_free(cda);
+    es_unit_check(success);
+}
+
+es_unit(chunked_dynamic_array_blocks) {
+    es_chunked_da(u64_t) cda = {0};
+    usize_t per_block = ES_CHUNKED_DA_BLOCK_SIZE / sizeof(u64_t);
+    for (u64_t i = 0; i < per_block * 2 + 3; i++) {
+        es_chunked_da_push(cda, i);
+    }
+
+    u64_t sum = 0;
+    for (usize_t b = 0; b < es_chunked_da_block_count(cda); b++) {
+        u64_t *block = es_chunked_da_block(cda, b);
+        for (usize_t i = 0; i < es_chunked_da_block_len(cda, b); i++) {
+            sum += block[i];
+        }
+    }
+    u64_t n = per_block * 2 + 3;
+    b8_t success = (es_chunked_da_block_count(cda) == 3 && es_chunked_da_block_len(cda, 2) == 3 && sum == n * (n - 1) / 2);
+    es_chunked_da_free(cda);
+    es_unit_check(success);
+}
+
+es_unit(chunked_dynamic_array_pop) {
+    es_chunked_da(i32_t) cda = {0};
+    for (i32_t i = 0; i < 2000; i++) {
+        es_chunked_da_push(cda, i);
+    }
+    i32_t last = 0;
+    es_chunked_da_pop(cda, &last);
+    while (es_chunked_da_count(cda) > 10) {
+        es_chunked_da_pop(cda, NULL);
+    }
+    es_chunked_da_shrink_to_fit(cda);
+
+    b8_t success = (last == 1999 && es_da_count(cda.da.blocks) == 1 && es_chunked_da_last(cda) == 9);
+    es_chunked_da_free(cda);
+    es_unit_check(success);
+}
+
+es_unit(ring_fifo) {
+    es_ring(i32_t) ring = {0};
+    b8_t success = true;
+    i32_t next = 0;
+    // Interleave pushes and pops so entries wrap around while growing.
+    for (i32_t i = 0; i < 1000; i++) {
+        es_ring_push_back(ring, i);
+        if (i % 3 == 0) {
+            i32_t value;
+            es_ring_pop_front(ring, &value);
+            success = (value == next++) && success;
+        }
+    }
+    while (es_ring_count(ring) > 0) {
+        i32_t value;
+        es_ring_pop_front(ring, &value);
+        success = (value == next++) && success;
+    }
+
+    success = (next == 1000 && (es_ring_cap(ring) & (es_ring_cap(ring) - 1)) == 0) && success;
+    es_ring_free(ring);
+    es_unit_check(success);
+}
+
+es_unit(ring_deque) {
+    es_deque(i32_t) deque = {0};
+    for (i32_t i = 0; i < 20; i++) {
+        es_ring_push_front(deque, -i);
+        es_ring_push_back(deque, i);
+    }
+    i32_t back, front;
+    es_ring_pop_back(deque, &back);
+    es_ring_pop_front(deque, &front);
+
+    b8_t success = (back == 19 && front == -19 && es_ring_count(deque) == 38 &&
+                    es_ring_front(deque) == -18 && es_ring_back(deque) == 18 && es_ring_at(deque, 19) == 0);
+    es_ring_free(deque);
+    es_unit_check(success);
+}
+
+es_unit(ring_bulk_and_spans) {
+    es_ring(i32_t) ring = {0};
+    i32_t data[12];
+    for (i32_t i = 0; i < 12; i++) {
+        data[i] = i;
+    }
+    es_ring_push_back_arr(ring, data, 12);
+    es_ring_pop_front_arr(ring, 10, NULL);
+    // Wraps around the end of the 16 entry buffer.
+    es_ring_push_back_arr(ring, data, 12);
+
+    usize_t len0, len1;
+    i32_t *span0 = es_ring_span(ring, 0, &len0);
+    i32_t *span1 = es_ring_span(ring, len0, &len1);
+    b8_t success = (es_ring_cap(ring) == 16 && len0 == 6 && len1 == 8 &&
+                    span0[0] == 10 && span0[2] == 0 && span1[0] == 4 && span1[7] == 11);
+
+    i32_t out[14];
+    es_ring_pop_front_arr(ring, 14, out);
+    success = (out[1] == 11 && out[13] == 11 && es_ring_count(ring) == 0) && success;
+    es_ring_free(ring);
+    es_unit_check(success);
+}
+
+#define PARTICLE_FIELDS(X) \
+    X(vec3_t, pos) \
+    X(vec3_t, vel) \
+    X(f32_t, life)
+
+es_unit(soa_push_remove) {
+    es_soa(PARTICLE_FIELDS) particles;
+    es_soa_init(particles, PARTICLE_FIELDS);
+    for (i32_t i = 0; i < 100; i++) {
+        usize_t p = es_soa_push(particles);
+        particles.pos[p] = vec3s(i);
+        particles.life[p] = i;
+    }
+    es_soa_remove(particles, 0);
+    es_soa_remove_fast(particles, 0);
+    es_soa_swap(particles, 0, 1);
+
+    b8_t success = (es_soa_count(particles) == 98 &&
+                    particles.life[0] == 2 && particles.pos[0].x == 2 &&
+                    particles.life[1] == 99 && particles.pos[1].z == 99 &&
+                    particles.vel[97].y == 0 && particles.life[97] == 98);
+    es_soa_free(particles);
+    es_unit_check(success && particles.pos == NULL);
+}
@@ -106,3 +106,332 @@ es_unit(hash_table_iteration) {
 
     es_unit_success();
 }
+
+es_unit(hash_table_update) {
+    es_hash_table(i32_t, i32_t) ht = NULL;
+    es_hash_table_insert(ht, 7, 1);
+    es_hash_table_insert(ht, 7, 2);
+
+    b8_t success = (es_hash_table_count(ht) == 1 && es_hash_table_get(ht, 7) == 2);
+    es_hash_table_free(ht);
+    es_unit_check(success);
+}
+
+es_unit(hash_table_string_key_equality) {
+    es_hash_table(const char *, i32_t) ht = NULL;
+    es_hash_table_string_key(ht);
+    char a[] = "hello", b[] = "hello";
+    es_hash_table_insert(ht, a, 1);
+    es_hash_table_insert(ht, b, 2);
+
+    // Keys are compared by content, not by pointer.
+    b8_t success = (es_hash_table_count(ht) == 1 && es_hash_table_get(ht, "hello") == 2 &&
+                    es_hash_table_contains(ht, "hello") && !es_hash_table_contains(ht, "world"));
+    es_hash_table_free(ht);
+    es_unit_check(success);
+}
+
+es_unit(hash_table_tombstones) {
+    es_hash_table(i32_t, i32_t) ht = NULL;
+    b8_t success = true;
+    // Churn keys so removals leave tombstones inside probe sequences.
+    for (i32_t round = 0; round < 50; round++) {
+        for (i32_t i = 0; i < 100; i++) {
+            es_hash_table_insert(ht, round * 100 + i, i);
+        }
+        for (i32_t i = 0; i < 100; i += 2) {
+            es_hash_table_remove(ht, round * 100 + i);
+        }
+    }
+    for (i32_t round = 0; round < 50; round++) {
+        for (i32_t i = 0; i < 100; i++) {
+            b8_t alive = es_hash_table_contains(ht, round * 100 + i);
+            success = (alive == (i % 2 == 1)) && success;
+            success = (!alive || es_hash_table_get(ht, round * 100 + i) == i) && success;
+        }
+    }
+
+    success = (es_hash_table_count(ht) == 2500 && ht->count + ht->tombstones < es_da_count(ht->entries)) && success;
+    es_hash_table_free(ht);
+    es_unit_check(success);
+}
+
+es_unit(hash_table_iter_remove) {
+    es_hash_table(i32_t, b8_t) ht = NULL;
+    ht_fill(ht);
+
+    for (es_hash_table_iter_t iter = es_hash_table_iter_new(ht); es_hash_table_iter_valid(ht, iter); es_hash_table_iter_advance(ht, iter)) {
+        if (!es_hash_table_iter_get(ht, iter)) {
+            es_hash_table_iter_remove(ht, iter);
+        }
+    }
+
+    b8_t success = (es_hash_table_count(ht) == 5 && es_hash_table_contains(ht, 2) && !es_hash_table_contains(ht, 3));
+    es_hash_table_free(ht);
+    es_unit_check(success);
+}
+
+es_unit(hash_table_large) {
+    es_hash_table(u64_t, u64_t) ht = NULL;
+    for (u64_t i = 0; i < 100000; i++) {
+        es_hash_table_insert(ht, i * 3, i);
+    }
+
+    b8_t success = (es_hash_table_count(ht) == 100000);
+    for (u64_t i = 0; i < 100000; i++) {
+        success = (es_hash_table_get(ht, i * 3) == i && !es_hash_table_contains(ht, i * 3 + 1)) && success;
+    }
+    es_hash_table_free(ht);
+    es_unit_check(success);
+}
+
+es_unit(hash_table_reserve) {
+    es_hash_table(i32_t, i32_t) ht = NULL;
+    es_hash_table_reserve(ht, 1000);
+    void *entries = ht->entries;
+    usize_t cap = es_da_count(ht->ctrl);
+    for (i32_t i = 0; i < 1000; i++) {
+        es_hash_table_insert(ht, i, i);
+    }
+
+    // Capacity is a power of two and bulk loading never rehashed.
+    b8_t success = ((cap & (cap - 1)) == 0 && ht->entries == entries && es_hash_table_get(ht, 999) == 999);
+    es_hash_table_free(ht);
+    es_unit_check(success);
+}
+
+es_unit(hash_table_max_load) {
+    es_hash_table(i32_t, i32_t) ht = NULL;
+    es_hash_table_max_load(ht, 0.5f);
+    for (i32_t i = 0; i < 100; i++) {
+        es_hash_table_insert(ht, i, i);
+    }
+
+    b8_t success = (es_da_count(ht->ctrl) == 256 && es_hash_table_count(ht) == 100);
+    es_hash_table_free(ht);
+    es_unit_check(success);
+}
+
+static usize_t constant_hash(const void *data, usize_t len, usize_t seed) {
+    (void) data;
+    (void) len;
+    (void) seed;
+    return 7;
+}
+
+es_unit(hash_table_hash_func) {
+    es_hash_table(i32_t, i32_t) ht = NULL;
+    es_hash_table_hash_func(ht, constant_hash);
+    // Every key collides, so lookups rely on key equality alone.
+    for (i32_t i = 0; i < 100; i++) {
+        es_hash_table_insert(ht, i, i * 3);
+    }
+
+    b8_t success = (es_hash_table_count(ht) == 100 && es_hash_table_get(ht, 57) == 171 && !es_hash_table_contains(ht, 100));
+    es_hash_table_free(ht);
+    es_unit_check(success);
+}
+
+es_unit(hash_table_incremental) {
+    es_hash_table(i32_t, i32_t) ht = NULL;
+    es_hash_table_incremental(ht);
+
+    // Mirror of the expected contents, -1 marking missing keys.
+    enum { KEYS = 20000 };
+    static i32_t expected[KEYS];
+    memset(expected, -1, sizeof(expected));
+
+    b8_t migrating = false;
+    for (i32_t i = 0; i < KEYS; i++) {
+        es_hash_table_insert(ht, i, i);
+        expected[i] = i;
+        migrating = migrating || ht->old_ctrl != NULL;
+        // Touch keys that may still live in the old arrays.
+        if (i % 7 == 0) {
+            es_hash_table_insert(ht, i / 2, i);
+            expected[i / 2] = i;
+            es_hash_table_remove(ht, i / 3);
+            expected[i / 3] = -1;
+        }
+    }
+
+    b8_t success = true;
+    usize_t alive = 0;
+    for (i32_t i = 0; i < KEYS; i++) {
+        alive += expected[i] != -1;
+        success = (es_hash_table_contains(ht, i) == (expected[i] != -1)) && success;
+        success = (expected[i] == -1 || es_hash_table_get(ht, i) == expected[i]) && success;
+    }
+
+    // Lookups leave the old arrays alone until the rehash is finished.
+    es_hash_table_finish_rehash(ht);
+    success = ht->old_ctrl == NULL && success;
+
+    usize_t iterated = 0;
+    for (es_hash_table_iter_t iter = es_hash_table_iter_new(ht); es_hash_table_iter_valid(ht, iter); es_hash_table_iter_advance(ht, iter)) {
+        iterated++;
+    }
+
+    success = (migrating && es_hash_table_count(ht) == alive && iterated == alive) && success;
+    es_hash_table_free(ht);
+    es_unit_check(success);
+}
+
+typedef struct ht_point_t {
+    i32_t x;
+    i32_t y;
+} ht_point_t;
+
+es_unit(hash_table_struct_key) {
+    es_hash_table(ht_point_t, i32_t) ht = NULL;
+    ht_point_t point = {3, -7};
+    es_hash_table_insert(ht, point, 21);
+
+    b8_t success = (es_hash_table_get(ht, point) == 21 && es_hash_table_contains(ht, point) &&
+                    !es_hash_table_contains(ht, ((ht_point_t) {-7, 3})));
+    es_hash_table_free(ht);
+    es_unit_check(success);
+}
+
+es_unit(chash_table_basic) {
+    es_chash_table(const char *, i32_t) ht = NULL;
+    es_chash_table_init_string_key(ht);
+    char key[] = "foo";
+    es_chash_table_insert(ht, key, 1);
+    es_chash_table_insert(ht, "foo", 2);
+    es_chash_table_insert(ht, "bar", 3);
+
+    i32_t value = 0;
+    b8_t success = (es_chash_table_get(ht, "foo", &value) && value == 2 &&
+                    es_chash_table_remove(ht, "bar") && !es_chash_table_remove(ht, "bar") &&
+                    !es_chash_table_contains(ht, "bar") && es_chash_table_count(ht) == 1);
+    es_chash_table_free(ht);
+    es_unit_check(success);
+}
+
+typedef es_chash_table(u32_t, u32_t) chash_u32_t;
+
+typedef struct chash_worker_t {
+    chash_u32_t ht;
+    u32_t id;
+    b8_t success;
+} chash_worker_t;
+
+static void chash_increment(void *value, b8_t exists, void *user) {
+    (void) exists;
+    (void) user;
+    (*(u32_t *) value)++;
+}
+
+static void chash_worker(void *arg) {
+    chash_worker_t *worker = arg;
+    worker->success = true;
+    for (u32_t i = 0; i < 5000; i++) {
+        u32_t key = worker->id * 5000 + i;
+        es_chash_table_insert(worker->ht, key, key * 2);
+        es_chash_table_upsert(worker->ht, 0xffffffff, chash_increment, NULL);
+
+        u32_t value = 0;
+        worker->success = es_chash_table_get(worker->ht, key, &value) && value == key * 2 && worker->success;
+        if (i % 2 == 0) {
+            worker->success = es_chash_table_remove(worker->ht, key) && worker->success;
+        }
+    }
+}
+
+es_unit(chash_table_threads) {
+    chash_u32_t ht = NULL;
+    es_chash_table_init(ht);
+    es_chash_table_reserve(ht, 1000);
+
+    chash_worker_t workers[4];
+    es_thread_t threads[4];
+    for (u32_t i = 0; i < 4; i++) {
+        workers[i] = (chash_worker_t) { ht, i, false };
+        threads[i] = es_thread(chash_worker, &workers[i]);
+    }
+    b8_t success = true;
+    for (u32_t i = 0; i < 4; i++) {
+        es_thread_wait(threads[i]);
+        success = workers[i].success && success;
+    }
+
+    u32_t hits = 0;
+    success = (es_chash_table_get(ht, 0xffffffff, &hits) && hits == 20000 &&
+               es_chash_table_count(ht) == 10001 && es_chash_table_contains(ht, 3 * 5000 + 1)) && success;
+    es_chash_table_free(ht);
+    es_unit_check(success);
+}
+
+es_unit(hash_set_basic) {
+    es_hash_set(i32_t) hs = NULL;
+    for (i32_t i = 0; i < 1000; i++) {
+        es_hash_set_insert(hs, i % 500);
+    }
+    es_hash_set_remove(hs, 7);
+
+    i64_t sum = 0;
+    for (es_hash_set_iter_t iter = es_hash_set_iter_new(hs); es_hash_set_iter_valid(hs, iter); es_hash_set_iter_advance(hs, iter)) {
+        sum += es_hash_set_iter_get(hs, iter);
+    }
+
+    // Entries hold nothing but the key.
+    b8_t success = (sizeof(*hs->entries) == sizeof(i32_t) &&
+                    es_hash_set_count(hs) == 499 && sum == 499 * 500 / 2 - 7 &&
+                    es_hash_set_contains(hs, 499) && !es_hash_set_contains(hs, 7) && !es_hash_set_contains(hs, 500));
+    es_hash_set_free(hs);
+    es_unit_check(success);
+}
+
+es_unit(hash_set_string_key) {
+    es_hash_set(const char *) hs = NULL;
+    es_hash_set_string_key(hs);
+
+    es_arena_t arena = es_arena_init(0);
+    char key[16];
+    for (i32_t i = 0; i < 300; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        es_hash_set_insert(hs, es_str_arena(key, &arena));
+    }
+
+    // Lookups compare characters, not pointers.
+    snprintf(key, sizeof(key), "key%d", 123);
+    b8_t success = (es_hash_set_count(hs) == 300 && es_hash_set_contains(hs, key) && !es_hash_set_contains(hs, "key300"));
+
+    es_hash_set_free(hs);
+    es_arena_free(&arena);
+    es_unit_check(success);
+}
+
+es_unit(hash_multimap_runs) {
+    es_hash_multimap(i32_t, i32_t) mm = {0};
+
+    // Interleaved inserts keep relocating runs, which forces compaction.
+    for (i32_t i = 0; i < 10000; i++) {
+        es_hash_multimap_insert(mm, i % 37, i);
+    }
+    es_hash_multimap_remove(mm, 5);
+
+    b8_t success = (es_hash_multimap_key_count(mm) == 36 && !es_hash_multimap_contains(mm, 5));
+    usize_t total = 0;
+    for (es_hash_multimap_iter_t iter = es_hash_multimap_iter_new(mm); es_hash_multimap_iter_valid(mm, iter); es_hash_multimap_iter_advance(mm, iter)) {
+        i32_t key = es_hash_multimap_iter_get_key(mm, iter);
+        usize_t count;
+        i32_t *values = es_hash_multimap_iter_get(mm, iter, &count);
+        // Values are contiguous and in insertion order.
+        for (usize_t i = 0; i < count; i++) {
+            success = values[i] == key + (i32_t) i * 37 && success;
+        }
+        total += count;
+    }
+
+    usize_t missing_count = 1;
+    i32_t *missing = es_hash_multimap_get(mm, 5, &missing_count);
+    usize_t count;
+    i32_t *values = es_hash_multimap_get(mm, 36, &count);
+    success = (missing == NULL && missing_count == 0 && count == 270 && values[269] == 36 + 269 * 37 &&
+               total == es_hash_multimap_count(mm) && mm.holes <= 2 * es_hash_multimap_count(mm)) && success;
+
+    es_hash_multimap_free(mm);
+    es_unit_check(success);
+}
@@ -0,0 +1,234 @@
+#include "es_header.h"
+
+es_unit(arena_allocate) {
+    es_arena_t arena = es_arena_init(0);
+
+    u8_t *a = es_arena_alloc(&arena, 3);
+    u8_t *b = es_arena_alloc(&arena, 5);
+    b8_t success = ((usize_t) a % ES_ARENA_ALIGNMENT == 0 && (usize_t) b % ES_ARENA_ALIGNMENT == 0 && b - a == ES_ARENA_ALIGNMENT);
+
+    es_arena_free(&arena);
+    es_unit_check(success && arena.chunk == NULL);
+}
+
+es_unit(arena_chunk_chaining) {
+    es_arena_t arena = es_arena_init(64);
+
+    es_arena_alloc(&arena, 48);
+    _es_arena_chunk_t *first = arena.chunk;
+    es_arena_alloc(&arena, 48);
+    // Allocations larger than the chunk size get a chunk of their own.
+    es_arena_alloc(&arena, 256);
+    b8_t success = (arena.chunk->prev->prev == first && arena.chunk->cap == 256);
+
+    es_arena_free(&arena);
+    es_unit_check(success);
+}
+
+es_unit(arena_realloc_in_place) {
+    es_arena_t arena = es_arena_init(0);
+
+    i32_t *a = es_arena_alloc(&arena, 4 * sizeof(i32_t));
+    a[3] = 42;
+    i32_t *b = es_arena_realloc(&arena, a, 4 * sizeof(i32_t), 64 * sizeof(i32_t));
+    es_arena_alloc(&arena, 1);
+    i32_t *c = es_arena_realloc(&arena, b, 64 * sizeof(i32_t), 128 * sizeof(i32_t));
+    b8_t success = (a == b && b != c && c[3] == 42);
+
+    es_arena_free(&arena);
+    es_unit_check(success);
+}
+
+es_unit(arena_rewind) {
+    es_arena_t arena = es_arena_init(64);
+
+    es_arena_alloc(&arena, 16);
+    es_arena_mark_t mark = es_arena_mark(&arena);
+    es_arena_alloc(&arena, 32);
+    es_arena_alloc(&arena, 128);
+    es_arena_rewind(&arena, mark);
+    b8_t success = (arena.chunk == mark.chunk && arena.chunk->used == 16);
+
+    es_arena_free(&arena);
+    es_unit_check(success);
+}
+
+es_unit(arena_reset) {
+    es_arena_t arena = es_arena_init(64);
+
+    es_arena_alloc(&arena, 64);
+    es_arena_alloc(&arena, 64);
+    es_arena_reset(&arena);
+    // Chunks are coalesced so the same workload fits in one chunk.
+    b8_t success = (arena.chunk->prev == NULL && arena.chunk->used == 0 && arena.chunk->cap == 128);
+
+    es_arena_free(&arena);
+    es_unit_check(success);
+}
+
+es_unit(arena_containers) {
+    es_arena_t arena = es_arena_init(0);
+
+    es_da(i32_t) da = NULL;
+    es_da_init_arena(da, &arena);
+    for (i32_t i = 0; i < 100; i++) {
+        es_da_push(da, i);
+    }
+
+    es_str_t str = es_str_arena("abc", &arena);
+    es_str_concat(&str, "def");
+
+    es_hash_table(i32_t, i32_t) ht = NULL;
+    es_hash_table_init_arena(ht, &arena);
+    for (i32_t i = 0; i < 100; i++) {
+        es_hash_table_insert(ht, i, i * 2);
+    }
+
+    b8_t success = (es_da_count(da) == 100 && da[99] == 99 &&
+                    es_str_cmp(str, "abcdef") == 0 &&
+                    es_hash_table_count(ht) == 100 && es_hash_table_get(ht, 42) == 84);
+
+    es_da_free(da);
+    es_str_free(&str);
+    es_hash_table_free(ht);
+    es_arena_free(&arena);
+    es_unit_check(success);
+}
+
+typedef struct counting_allocator_t {
+    usize_t allocs;
+    usize_t frees;
+    isize_t bytes;
+} counting_allocator_t;
+
+static void *counting_alloc(usize_t size, void *user) {
+    counting_allocator_t *counter = user;
+    counter->allocs++;
+    counter->bytes += size;
+    return malloc(size);
+}
+
+static void *counting_realloc(void *ptr, usize_t old_size, usize_t new_size, void *user) {
+    counting_allocator_t *counter = user;
+    counter->bytes += (isize_t) new_size - (isize_t) old_size;
+    return realloc(ptr, new_size);
+}
+
+static void counting_free(void *ptr, usize_t size, void *user) {
+    counting_allocator_t *counter = user;
+    counter->frees++;
+    counter->bytes -= size;
+    free(ptr);
+}
+
+es_unit(allocator_binding) {
+    counting_allocator_t counter = {0};
+    es_allocator_t allocator = { counting_alloc, counting_realloc, counting_free, &counter };
+
+    es_da(i32_t) da = NULL;
+    es_da_init_allocator(da, &allocator);
+    for (i32_t i = 0; i < 100; i++) {
+        es_da_push(da, i);
+    }
+    es_str_t str = es_str_allocator("abc", &allocator);
+    es_str_concat(&str, "def");
+    es_hash_table(i32_t, i32_t) ht = NULL;
+    es_hash_table_init_allocator(ht, &allocator);
+    for (i32_t i = 0; i < 100; i++) {
+        es_hash_table_insert(ht, i, i);
+    }
+
+    // Heap containers don't touch the allocator.
+    es_da(i32_t) heap = NULL;
+    es_da_push(heap, 1);
+    es_da_free(heap);
+
+    b8_t success = (counter.allocs >= 4 && counter.bytes > 0);
+    es_da_free(da);
+    es_str_free(&str);
+    es_hash_table_free(ht);
+
+    es_unit_check(success && counter.frees == counter.allocs && counter.bytes == 0);
+}
+
+es_unit(pool_allocate) {
+    es_pool_t pool = es_pool_init(sizeof(i32_t), 4);
+
+    i32_t *a = es_pool_alloc(&pool);
+    i32_t *b = es_pool_alloc(&pool);
+    es_pool_release(&pool, a);
+    // Released blocks are reused first.
+    i32_t *c = es_pool_alloc(&pool);
+    b8_t success = (a == c && a != b && (usize_t) b % ES_POOL_ALIGNMENT == 0);
+
+    es_pool_free(&pool);
+    es_unit_check(success);
+}
+
+es_unit(pool_allocator_binding) {
+    es_pool_t pool = es_pool_init(64, 0);
+
+    es_str_t str = es_strn_allocator("abcdef", 6, es_pool_allocator(&pool));
+    void *block = _es_str_head(str);
+    es_str_free(&str);
+    b8_t success = (pool.free_list == block);
+
+    es_pool_free(&pool);
+    es_unit_check(success);
+}
+
+es_unit(pool_slab_growth) {
+    es_pool_t pool = es_pool_init(24, 4);
+
+    for (u32_t i = 0; i < 9; i++) {
+        es_pool_alloc(&pool);
+    }
+    b8_t success = (pool.slab->prev->prev != NULL && pool.slab->prev->prev->prev == NULL);
+
+    es_pool_free(&pool);
+    es_unit_check(success);
+}
+
+typedef struct pool_worker_t {
+    es_pool_t *pool;
+    b8_t success;
+} pool_worker_t;
+
+static void pool_worker(void *arg) {
+    pool_worker_t *worker = arg;
+    es_pool_cache_t cache = es_pool_cache_init(worker->pool);
+    u64_t *blocks[100];
+
+    worker->success = true;
+    for (u32_t round = 0; round < 10; round++) {
+        for (u64_t i = 0; i < es_arr_len(blocks); i++) {
+            blocks[i] = es_pool_cache_alloc(&cache);
+            *blocks[i] = i;
+        }
+        for (u64_t i = 0; i < es_arr_len(blocks); i++) {
+            worker->success = (*blocks[i] == i) && worker->success;
+            es_pool_cache_release(&cache, blocks[i]);
+        }
+    }
+    es_pool_cache_flush(&cache);
+}
+
+es_unit(pool_thread_cache) {
+    es_pool_t pool = es_pool_init(sizeof(u64_t), 0);
+
+    pool_worker_t workers[4];
+    es_thread_t threads[4];
+    for (u32_t i = 0; i < 4; i++) {
+        workers[i] = (pool_worker_t) { &pool, false };
+        threads[i] = es_thread(pool_worker, &workers[i]);
+    }
+
+    b8_t success = true;
+    for (u32_t i = 0; i < 4; i++) {
+        es_thread_wait(threads[i]);
+        success = workers[i].success && success;
+    }
+
+    es_pool_free(&pool);
+    es_unit_check(success);
+}
@@ -0,0 +1,60 @@
+// Routes es_malloc and friends in this file through the memory tracker.
+#define ES_MEMORY_DEBUG
+#include "es_header.h"
+
+#ifdef ES_OS_LINUX
+#include <unistd.h>
+#endif // ES_OS_LINUX
+
+es_unit(memory_debug_tracking) {
+    es_memory_stats_t before = es_memory_stats();
+
+    u8_t *a = es_malloc(100);
+    u8_t *b = es_calloc(4, 8);
+    a = es_realloc(a, 200);
+    es_memory_stats_t during = es_memory_stats();
+
+    // A failed reallocation keeps the block alive without counting a new allocation.
+    b8_t kept = es_realloc(b, (usize_t) 1 << 62) == NULL;
+    es_memory_stats_t failed = es_memory_stats();
+
+    es_free(a);
+    es_free(b);
+    es_memory_stats_t after = es_memory_stats();
+
+    es_unit_check(during.live_bytes - before.live_bytes == 232 &&
+                  during.live_count - before.live_count == 2 &&
+                  during.total_count - before.total_count == 3 &&
+                  during.peak_bytes >= during.live_bytes &&
+                  kept && failed.live_bytes == during.live_bytes &&
+                  failed.live_count == during.live_count && failed.total_count == during.total_count &&
+                  after.live_bytes == before.live_bytes &&
+                  after.live_count == before.live_count);
+}
+
+#ifdef ES_OS_LINUX
+es_unit(memory_debug_report) {
+    u8_t *leak = es_malloc(48);
+
+    // Capture the report by pointing stdout at a temporary file.
+    FILE *capture = tmpfile();
+    fflush(stdout);
+    int saved = dup(fileno(stdout));
+    dup2(fileno(capture), fileno(stdout));
+    es_memory_report();
+    fflush(stdout);
+    dup2(saved, fileno(stdout));
+    close(saved);
+
+    char report[4096] = {0};
+    rewind(capture);
+    usize_t len = fread(report, 1, sizeof(report) - 1, capture);
+    fclose(capture);
+    es_free(leak);
+
+    es_strview_t view = es_strview_len(report, len);
+    es_unit_check(es_strview_find(view, es_strview_lit("========== Memory ==========")) < len &&
+                  es_strview_find(view, es_strview_lit("memory_debug.c")) < len &&
+                  es_strview_find(view, es_strview_lit("memory_debug_report")) < len);
+}
+#endif // ES_OS_LINUX
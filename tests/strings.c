@@ -1,5 +1,18 @@
 #include "es_header.h"
 
+#ifdef ES_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif // ES_OS_LINUX
+
+// Test hooks from es_impl.c, kept out of the header since selecting swaps the
+// kernels under every thread. Selecting an index runs every string function
+// on that table, negative goes back to the best one the CPU supports. Fails
+// for tables the CPU can't run.
+extern usize_t _es_str_kernels_count(void);
+extern b8_t _es_str_kernels_select(isize_t index);
+
 es_unit(c_string_length) {
     es_unit_check(es_cstr_len("abcdef") == 6);
 }
@@ -57,6 +70,38 @@ es_unit(string_reserve) {
     es_unit_check(success);
 }
 
+es_unit(string_capacity_growth) {
+    es_str_t str = es_str_empty();
+    usize_t reallocs = 0;
+    usize_t cap = es_str_cap(str);
+    for (u32_t i = 0; i < 1000; i++) {
+        es_str_concat_char(&str, 'a' + i % 26);
+        if (es_str_cap(str) != cap) {
+            cap = es_str_cap(str);
+            reallocs++;
+        }
+    }
+
+    b8_t success = (es_str_len(str) == 1000 && str[1000] == '\0' && str[999] == 'a' + 999 % 26 && reallocs < 10);
+    es_str_free(&str);
+    es_unit_check(success);
+}
+
+es_unit(string_builder) {
+    es_str_builder_t builder = es_str_builder();
+    es_str_builder_reserve(&builder, 4);
+    es_str_builder_append(&builder, "abc");
+    es_str_builder_append_len(&builder, "defgh", 2);
+    es_str_builder_append_char(&builder, '-');
+    es_str_builder_appendf(&builder, "%d:%s", 42, "a long formatted piece which doesn't fit the spare capacity");
+    es_str_builder_appendf(&builder, "%c", '!');
+    es_str_t str = es_str_builder_finish(&builder);
+
+    b8_t success = (es_str_cmp(str, "abcde-42:a long formatted piece which doesn't fit the spare capacity!") == 0 && builder.str == NULL);
+    es_str_free(&str);
+    es_unit_check(success);
+}
+
 es_unit(string_compare) {
     es_str_t str = es_str("abcd");
     b8_t success = (es_str_cmp(str, "abcd") == 0 && es_str_cmp(str, "abcdef") != 0);
@@ -137,3 +182,293 @@ es_unit(string_valid) {
     b8_t not_valid = es_str_valid(str);
     es_unit_check(valid && !not_valid);
 }
+
+es_unit(string_intern) {
+    es_intern_t intern = es_intern_init();
+
+    char buffer[] = "hello";
+    u32_t a = es_intern(&intern, "hello");
+    u32_t b = es_intern(&intern, "world");
+    // Same characters from a different buffer get the same id and pointer.
+    u32_t c = es_intern(&intern, buffer);
+    u32_t d = es_intern_len(&intern, "hello world", 5);
+
+    b8_t success = (a != ES_INTERN_NONE && a != b && a == c && a == d &&
+                    es_intern_str(&intern, a) != buffer &&
+                    es_cstr_cmp(es_intern_str(&intern, b), "world") == 0 &&
+                    es_intern_find(&intern, "world") == b &&
+                    es_intern_find(&intern, "foo") == ES_INTERN_NONE &&
+                    es_intern_count(&intern) == 2);
+
+    es_intern_free(&intern);
+    es_unit_check(success && es_intern_count(&intern) == 0);
+}
+
+es_unit(string_view) {
+    es_strview_t view = es_strview("  hello world  ");
+    es_strview_t trimmed = es_strview_trim(view);
+    es_strview_t world = es_strview_sub(trimmed, 6, 100);
+
+    b8_t success = (es_strview_eq_cstr(trimmed, "hello world") &&
+                    es_strview_eq(world, es_strview_lit("world")) &&
+                    es_strview_cmp(es_strview_lit("abc"), es_strview_lit("abd")) < 0 &&
+                    es_strview_cmp(es_strview_lit("abc"), es_strview_lit("ab")) > 0 &&
+                    es_strview_starts_with(trimmed, es_strview_lit("hell")) &&
+                    es_strview_ends_with(trimmed, es_strview_lit("rld")) &&
+                    es_strview_find_char(trimmed, 'o') == 4 &&
+                    es_strview_find(trimmed, es_strview_lit("wor")) == 6 &&
+                    es_strview_find(trimmed, es_strview_lit("word")) == trimmed.len &&
+                    es_strview_find(es_strview_lit("aaab"), es_strview_lit("aab")) == 1);
+    es_unit_check(success);
+}
+
+es_unit(string_view_split) {
+    es_da(es_strview_t) fields = NULL;
+    es_strview_split_into(&fields, es_strview_lit("a,,bc,"), ',');
+
+    b8_t success = (es_da_count(fields) == 4 &&
+                    es_strview_eq_cstr(fields[0], "a") && fields[1].len == 0 &&
+                    es_strview_eq_cstr(fields[2], "bc") && fields[3].len == 0);
+    es_da_free(fields);
+
+    es_strview_tokenizer_t tokenizer = es_strview_tokenizer(es_strview_lit(" key = value;\n next "), es_strview_lit(" =;\n"));
+    const char *expected[] = {"key", "value", "next"};
+    es_strview_t token;
+    usize_t count = 0;
+    while (es_strview_tokenizer_next(&tokenizer, &token)) {
+        success = count < es_arr_len(expected) && es_strview_eq_cstr(token, expected[count]) && success;
+        count++;
+    }
+
+    es_unit_check(success && count == 3);
+}
+
+// Every length and alignment around the vector widths, checked against plain loops.
+static b8_t check_string_kernels(void) {
+    static char buffer[384];
+    b8_t success = true;
+    for (usize_t offset = 0; offset < 33; offset++) {
+        for (usize_t len = 0; len < 300; len++) {
+            char *str = buffer + offset;
+            for (usize_t i = 0; i < len; i++) {
+                str[i] = 'a' + (i * 7 + len) % 23;
+            }
+            str[len] = '\0';
+
+            usize_t expected_char = len;
+            for (usize_t i = 0; i < len && expected_char == len; i++) {
+                expected_char = str[i] == 'q' ? i : len;
+            }
+            usize_t expected_any = len;
+            for (usize_t i = 0; i < len && expected_any == len; i++) {
+                expected_any = (str[i] == 'q' || str[i] == 'w') ? i : len;
+            }
+
+            es_strview_t view = es_strview_len(str, len);
+            success = es_cstr_len(str) == len && success;
+            success = es_strview_find_char(view, 'q') == expected_char && success;
+            success = es_strview_find_any(view, es_strview_lit("wq")) == expected_any && success;
+            if (len >= 3) {
+                // Needles taken from the end exercise the last block.
+                es_strview_t needle = es_strview_sub(view, len - 3, 3);
+                usize_t found = es_strview_find(view, needle);
+                success = found <= len - 3 && memcmp(str + found, needle.data, 3) == 0 && success;
+            }
+            success = es_strview_find(view, es_strview_lit("zz")) == len && success;
+
+            char other[384];
+            memcpy(other, str, len + 1);
+            success = es_cstr_cmp(str, other) == 0 && success;
+            if (len > 0) {
+                other[len - 1]++;
+                success = es_cstr_cmp(str, other) < 0 && es_cstr_cmp_len(str, other, len - 1) == 0 && success;
+            }
+        }
+    }
+    return success;
+}
+
+es_unit(string_kernels) {
+    // Each table the CPU supports, not only the one picked for it.
+    b8_t success = true;
+    for (usize_t i = 0; i < _es_str_kernels_count(); i++) {
+        if (_es_str_kernels_select(i)) {
+            success = check_string_kernels() && success;
+        }
+    }
+    _es_str_kernels_select(-1);
+    es_unit_check(success);
+}
+
+#if defined(ES_OS_LINUX) || defined(ES_OS_WIN32)
+es_unit(string_kernels_guard_page) {
+    // Strings ending right before an inaccessible page must never be read past it.
+#ifdef ES_OS_LINUX
+    int zero = open("/dev/zero", O_RDWR);
+    char *pages = mmap(NULL, 8192, PROT_READ | PROT_WRITE, MAP_PRIVATE, zero, 0);
+    close(zero);
+    b8_t success = (pages != MAP_FAILED && mprotect(pages + 4096, 4096, PROT_NONE) == 0);
+#endif // ES_OS_LINUX
+#ifdef ES_OS_WIN32
+    char *pages = VirtualAlloc(NULL, 8192, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    DWORD old_protect;
+    b8_t success = (pages != NULL && VirtualProtect(pages + 4096, 4096, PAGE_NOACCESS, &old_protect));
+#endif // ES_OS_WIN32
+
+    for (usize_t i = 0; i < _es_str_kernels_count() && success; i++) {
+        if (!_es_str_kernels_select(i)) {
+            continue;
+        }
+        for (usize_t len = 0; len < 100; len++) {
+            char *str = pages + 4096 - len - 1;
+            char other[128];
+            memset(str, 'x', len);
+            str[len] = '\0';
+            memcpy(other, str, len + 1);
+            success = es_cstr_len(str) == len && success;
+            success = es_cstr_cmp(str, other) == 0 && es_cstr_cmp(other, str) == 0 && es_cstr_cmp_len(str, other, len + 1) == 0 && success;
+            if (len > 0) {
+                other[len - 1] = 'y';
+                success = es_cstr_cmp(str, other) == 'x' - 'y' && es_cstr_cmp(other, str) == 'y' - 'x' && success;
+            }
+        }
+    }
+    _es_str_kernels_select(-1);
+
+#ifdef ES_OS_LINUX
+    munmap(pages, 8192);
+#endif // ES_OS_LINUX
+#ifdef ES_OS_WIN32
+    VirtualFree(pages, 0, MEM_RELEASE);
+#endif // ES_OS_WIN32
+    es_unit_check(success);
+}
+#endif // ES_OS_LINUX, ES_OS_WIN32
+
+es_unit(small_string) {
+    es_sstr_t str = es_sstr("identifier");
+    b8_t success = (sizeof(es_sstr_t) == 24 && es_sstr_is_inline(&str) && es_sstr_len(&str) == 10);
+
+    // Exactly the inline capacity still fits.
+    es_sstr_append(&str, "_0123456789a");
+    success = es_sstr_is_inline(&str) && es_sstr_len(&str) == ES_SSTR_CAP && success;
+
+    es_sstr_append_char(&str, '!');
+    for (u32_t i = 0; i < 100; i++) {
+        es_sstr_append(&str, "xy");
+    }
+    success = (!es_sstr_is_inline(&str) && es_sstr_len(&str) == ES_SSTR_CAP + 201 &&
+               es_cstr_cmp_len(es_sstr_cstr(&str), "identifier_0123456789a!xyxy", 27) == 0 &&
+               es_sstr_cstr(&str)[es_sstr_len(&str)] == '\0') && success;
+    es_sstr_free(&str);
+    success = es_sstr_len(&str) == 0 && es_sstr_is_inline(&str) && success;
+
+    // Appending a string to itself while it moves to the heap and while it grows there.
+    es_sstr_t twice = es_sstr("abcdefghijklmnop");
+    success = es_sstr_append(&twice, es_sstr_cstr(&twice)) && success;
+    success = es_sstr_cmp(&twice, "abcdefghijklmnopabcdefghijklmnop") == 0 && success;
+    success = es_sstr_append(&twice, es_sstr_cstr(&twice)) && success;
+    success = es_sstr_cmp(&twice, "abcdefghijklmnopabcdefghijklmnopabcdefghijklmnopabcdefghijklmnop") == 0 && success;
+    es_sstr_free(&twice);
+
+    es_sstr_t number = es_sstr_i64(-9223372036854775807ll - 1);
+    es_sstr_t max = es_sstr_u64(18446744073709551615ull);
+    es_sstr_t flag = es_sstr_b8(false);
+    success = (es_sstr_cmp(&number, "-9223372036854775808") == 0 && es_sstr_cmp(&max, "18446744073709551615") == 0 &&
+               es_sstr_cmp(&flag, "false") == 0 && es_sstr_is_inline(&number)) && success;
+
+    es_unit_check(success);
+}
+
+es_unit(number_to_buf) {
+    char buf[ES_F64_BUF_SIZE];
+    b8_t success = true;
+
+    success = es_u64_to_buf(0, buf) == 1 && es_cstr_cmp(buf, "0") == 0 && success;
+    success = es_u64_to_buf(18446744073709551615ull, buf) == 20 && es_cstr_cmp(buf, "18446744073709551615") == 0 && success;
+    success = es_i64_to_buf(-9223372036854775807ll - 1, buf) == 20 && es_cstr_cmp(buf, "-9223372036854775808") == 0 && success;
+    for (u64_t value = 1; value < 1000000; value = value * 3 + 1) {
+        char expected[ES_U64_BUF_SIZE];
+        snprintf(expected, sizeof(expected), "%llu", (unsigned long long) value);
+        success = es_u64_to_buf(value, buf) == es_cstr_len(expected) && es_cstr_cmp(buf, expected) == 0 && success;
+    }
+
+    const struct { f64_t value; const char *text; } floats[] = {
+        { 0.0, "0" }, { -0.0, "-0" }, { 1.0, "1" }, { -1.5, "-1.5" }, { 0.1, "0.1" },
+        { 0.3, "0.3" }, { 1.0 / 3.0, "0.3333333333333333" }, { 123456.789, "123456.789" },
+        { 1e21, "1e+21" }, { 1e20, "100000000000000000000" }, { 1e-7, "1e-7" },
+        { 0.000001, "0.000001" }, { 5e-324, "5e-324" }, { 1.7976931348623157e308, "1.7976931348623157e+308" },
+        { 2.5e-10, "2.5e-10" }, { INFINITY, "inf" }, { -INFINITY, "-inf" }, { NAN, "nan" },
+    };
+    for (usize_t i = 0; i < es_arr_len(floats); i++) {
+        usize_t len = es_f64_to_buf(floats[i].value, buf);
+        success = len == es_cstr_len(floats[i].text) && es_cstr_cmp(buf, floats[i].text) == 0 && success;
+    }
+
+    // Every printed float parses back to the same bits.
+    u64_t state = 0x9e3779b97f4a7c15ull;
+    for (u32_t i = 0; i < 100000; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        f64_t value;
+        memcpy(&value, &state, sizeof(value));
+        if (isnan(value)) {
+            continue;
+        }
+        es_f64_to_buf(value, buf);
+        f64_t parsed = strtod(buf, NULL);
+        success = memcmp(&parsed, &value, sizeof(value)) == 0 && success;
+    }
+
+    es_str_t str = es_str_f64(0.25);
+    success = es_str_cmp(str, "0.25") == 0 && success;
+    es_str_free(&str);
+
+    es_unit_check(success);
+}
+
+es_unit(number_parse) {
+    b8_t success = true;
+    u64_t u = 0;
+    i64_t i = 0;
+    f64_t f = 0.0;
+
+    success = es_parse_u64(es_strview_lit("1234567890123456789x"), &u) == 19 && u == 1234567890123456789ull && success;
+    success = es_parse_u64(es_strview_lit("18446744073709551615"), &u) == 20 && u == 18446744073709551615ull && success;
+    success = es_parse_u64(es_strview_lit("18446744073709551616"), &u) == 0 && success;
+    success = es_parse_u64(es_strview_lit("x1"), &u) == 0 && success;
+    success = es_parse_u64(es_strview_len("42", 1), &u) == 1 && u == 4 && success;
+    success = es_parse_i64(es_strview_lit("-9223372036854775808"), &i) == 20 && i == -9223372036854775807ll - 1 && success;
+    success = es_parse_i64(es_strview_lit("9223372036854775808"), &i) == 0 && success;
+    success = es_parse_i64(es_strview_lit("+17,"), &i) == 3 && i == 17 && success;
+    success = es_parse_i64(es_strview_lit("-"), &i) == 0 && success;
+
+    const char *floats[] = {
+        "0", "-0.0", "1.5", "0.1", "3.14159", "1e10", "2.5E-3", "123456789012345678901234567890",
+        "0.30000000000000004", "4.9406564584124654e-324", "1.7976931348623157e308", "1e400", "-1e-400",
+        "9007199254740993", "1e23", ".5", "7.", "0.000000000000000000000000001",
+        // Past the exact fast path, ties, subnormals and more digits than fit the mantissa.
+        "0.8504238128931516", "2.2250738585072011e-308", "2.4703282292062328e-324", "9007199254740992.5",
+        "9007199254740993.0000000000000000001", "2.225073858507201136057409796709131975934819546351645648e-308",
+    };
+    for (usize_t j = 0; j < es_arr_len(floats); j++) {
+        f64_t expected = strtod(floats[j], NULL);
+        usize_t len = es_parse_f64(es_strview(floats[j]), &f);
+        success = len == es_cstr_len(floats[j]) && memcmp(&f, &expected, sizeof(f)) == 0 && success;
+    }
+    // A trailing exponent marker without digits isn't part of the number.
+    success = es_parse_f64(es_strview_lit("2e+"), &f) == 1 && f == 2.0 && success;
+    success = es_parse_f64(es_strview_lit("-Infinity"), &f) == 9 && f == -INFINITY && success;
+    success = es_parse_f64(es_strview_lit("nan"), &f) == 3 && isnan(f) && success;
+    success = es_parse_f64(es_strview_lit("."), &f) == 0 && success;
+
+    // Printing and parsing round trip.
+    char buf[ES_F64_BUF_SIZE];
+    for (f64_t value = 1e-300; value < 1e300; value *= 1.37) {
+        usize_t len = es_f64_to_buf(value, buf);
+        success = es_parse_f64(es_strview_len(buf, len), &f) == len && f == value && success;
+    }
+
+    es_unit_check(success);
+}
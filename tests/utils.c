@@ -43,6 +43,75 @@ es_unit(utility_lerp) {
     es_unit_check(lerped000 == 0.0f && lerped025 == 2.5f && lerped050 == 5.0f && lerped075 == 7.5 && lerped100 == 10.0f);
 }
 
+es_unit(utility_hash_str) {
+    // djb2, which callers may have stored hashes of.
+    es_unit_check(sizeof(usize_t) != 8 || (es_hash_str("") == 5381 && es_hash_str("a") == 5381 * 33 + 'a'));
+}
+
+es_unit(utility_wyhash_vectors) {
+    // Reference vectors published with wyhash final version 4.
+    b8_t success = (es_wyhash("", 0, 0) == 0x93228a4de0eec5a2ull &&
+                    es_wyhash("a", 1, 1) == 0xc5bac3db178713c4ull &&
+                    es_wyhash("abc", 3, 2) == 0xa97f2f7b1d9b3314ull &&
+                    es_wyhash("message digest", 14, 3) == 0x786d1f1df3801df4ull &&
+                    es_wyhash("abcdefghijklmnopqrstuvwxyz", 26, 4) == 0xdca5a8138ad37c87ull &&
+                    es_wyhash("12345678901234567890123456789012345678901234567890123456789012345678901234567890", 80, 6) == 0x6cc5eab49a92d617ull);
+    es_unit_check(success);
+}
+
+es_unit(utility_hasher_streaming) {
+    u8_t data[200];
+    for (usize_t i = 0; i < sizeof(data); i++) {
+        data[i] = (u8_t) (i * 31 + 7);
+    }
+
+    b8_t success = true;
+    const usize_t chunks[] = {1, 3, 16, 47, 48, 64};
+    for (usize_t len = 0; len <= sizeof(data); len++) {
+        usize_t expected = es_wyhash(data, len, 42);
+        for (usize_t c = 0; c < es_arr_len(chunks); c++) {
+            es_hasher_t hasher = es_hasher_init(42);
+            for (usize_t i = 0; i < len; i += chunks[c]) {
+                es_hasher_update(&hasher, data + i, es_min(chunks[c], len - i));
+            }
+            success = es_hasher_final(&hasher) == expected && success;
+        }
+    }
+    success = es_wyhash(data, 100, 1) != es_wyhash(data, 100, 2) && success;
+
+    es_unit_check(success);
+}
+
+// Find a child profile by name.
+static const _es_profile_t *find_profile(const _es_profile_t *parent, const char *name) {
+    for (usize_t i = 0; i < es_chunked_da_count(parent->children); i++) {
+        if (es_cstr_cmp(es_chunked_da_at(parent->children, i).name, name) == 0) {
+            return &es_chunked_da_at(parent->children, i);
+        }
+    }
+    return NULL;
+}
+
+es_unit(utility_profile) {
+    // One buffer holding changing names still gives every name its own profile.
+    char name[8];
+    for (u32_t i = 0; i < 6; i++) {
+        memcpy(name, i % 2 == 0 ? "even" : "odd", i % 2 == 0 ? 5 : 4);
+        if (i < 4)
+            es_profile(name) {
+                es_profile("inner") {
+                }
+            }
+    }
+
+    const _es_profile_t *even = find_profile(&_es_root_profile, "even");
+    const _es_profile_t *odd = find_profile(&_es_root_profile, "odd");
+    b8_t success = (even != NULL && odd != NULL && even->runs == 2 && odd->runs == 2 &&
+                    find_profile(even, "inner") != NULL && find_profile(even, "inner")->runs == 2 &&
+                    _es_curr_profile == &_es_root_profile);
+    es_unit_check(success);
+}
+
 //
-// TODO: Find a way to test hashing, get_time and sleep.
+// TODO: Find a way to test get_time and sleep.
 //